@@ -0,0 +1,320 @@
+// ap_wizard_bench: benchmarks for the core library, run against generated
+// option data and player YAMLs. Pass --benchmark_out=FILE
+// --benchmark_out_format=json to keep the results.
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "allocation_counter.h"
+#include "core_util.h"
+#include "game_definition.h"
+#include "item_filter.h"
+#include "random_specifier.h"
+#include "synthetic_data.h"
+#include "world.h"
+
+namespace {
+
+const std::filesystem::path& GetDataDirectory() {
+  static const std::filesystem::path* directory = [] {
+    auto* path = new std::filesystem::path(
+        std::filesystem::temp_directory_path() / "ap_wizard_bench");
+    std::filesystem::create_directories(*path);
+    return path;
+  }();
+
+  return *directory;
+}
+
+void WriteFile(const std::filesystem::path& path, const std::string& text) {
+  std::ofstream file(path, std::ios::binary);
+  file << text;
+}
+
+// Catalogues are generated once per size and shared between benchmarks.
+const std::string& GetCatalogFile(int items) {
+  static std::map<int, std::string>* filenames =
+      new std::map<int, std::string>();
+
+  auto it = filenames->find(items);
+  if (it == filenames->end()) {
+    SyntheticCatalogOptions options;
+    options.items = items;
+    options.locations = items * 2;
+
+    std::filesystem::path path =
+        GetDataDirectory() / ("options-" + std::to_string(items) + ".json");
+    WriteFile(path, GenerateDumpedOptions(options));
+
+    it = filenames->emplace(items, path.string()).first;
+  }
+
+  return it->second;
+}
+
+const GameDefinitions& GetGameDefinitions(int items) {
+  static std::map<int, std::unique_ptr<GameDefinitions>>* definitions =
+      new std::map<int, std::unique_ptr<GameDefinitions>>();
+
+  std::unique_ptr<GameDefinitions>& result = (*definitions)[items];
+  if (!result) {
+    result = std::make_unique<GameDefinitions>(GetCatalogFile(items));
+  }
+
+  return *result;
+}
+
+const Game& GetGame(int items) {
+  return GetGameDefinitions(items).GetGame("Game 1");
+}
+
+// The catalogue used by the world benchmarks, which vary the size of the
+// set options instead.
+constexpr int kWorldCatalogItems = 5000;
+
+const std::string& GetPlayerFile(int set_values) {
+  static std::map<int, std::string>* filenames =
+      new std::map<int, std::string>();
+
+  auto it = filenames->find(set_values);
+  if (it == filenames->end()) {
+    SyntheticWorldOptions options;
+    options.set_values = set_values;
+
+    std::filesystem::path path =
+        GetDataDirectory() / ("player-" + std::to_string(set_values) + ".yaml");
+    WriteFile(path,
+              GeneratePlayerYaml(GetGame(kWorldCatalogItems), options, 1));
+
+    it = filenames->emplace(set_values, path.string()).first;
+  }
+
+  return it->second;
+}
+
+// Reports the allocations made per iteration, when the core library is built
+// with AP_WIZARD_COUNT_ALLOCATIONS. Create it just before the benchmark loop.
+class AllocationReporter {
+ public:
+  explicit AllocationReporter(benchmark::State& state) : state_(state) {
+#ifdef AP_WIZARD_COUNT_ALLOCATIONS
+    start_counts_ = GetThreadAllocationCounts();
+#endif
+  }
+
+  ~AllocationReporter() {
+#ifdef AP_WIZARD_COUNT_ALLOCATIONS
+    AllocationCounts counts = GetThreadAllocationCounts() - start_counts_;
+    state_.counters["allocations"] = benchmark::Counter(
+        counts.allocations, benchmark::Counter::kAvgIterations);
+    state_.counters["allocated_bytes"] =
+        benchmark::Counter(counts.bytes, benchmark::Counter::kAvgIterations);
+#endif
+  }
+
+ private:
+  [[maybe_unused]] benchmark::State& state_;
+#ifdef AP_WIZARD_COUNT_ALLOCATIONS
+  AllocationCounts start_counts_;
+#endif
+};
+
+void BM_LoadGameDefinitions(benchmark::State& state) {
+  const std::string& filename = GetCatalogFile(state.range(0));
+
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    GameDefinitions game_definitions(filename);
+    benchmark::DoNotOptimize(game_definitions);
+  }
+}
+BENCHMARK(BM_LoadGameDefinitions)
+    ->Arg(1000)
+    ->Arg(20000)
+    ->Unit(benchmark::kMillisecond);
+
+void BM_WorldLoad(benchmark::State& state) {
+  const GameDefinitions& game_definitions =
+      GetGameDefinitions(kWorldCatalogItems);
+  const std::string& filename = GetPlayerFile(state.range(0));
+
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    World world(&game_definitions);
+    world.Load(filename);
+    benchmark::DoNotOptimize(world);
+  }
+
+  // The estimate from the diagnostics panel, for comparing layouts.
+  World world(&game_definitions);
+  world.Load(filename);
+  state.counters["world_bytes"] = world.GetMemoryUsage();
+}
+BENCHMARK(BM_WorldLoad)->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+void BM_WorldToYaml(benchmark::State& state) {
+  World world(&GetGameDefinitions(kWorldCatalogItems));
+  world.Load(GetPlayerFile(state.range(0)));
+
+  // Renaming the world invalidates the cached text, so that every iteration
+  // writes it out again.
+  bool flip = false;
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    world.SetName(flip ? "Bench" : "Bench2");
+    flip = !flip;
+
+    benchmark::DoNotOptimize(world.ToYaml());
+  }
+}
+BENCHMARK(BM_WorldToYaml)->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+void BM_WorldSave(benchmark::State& state) {
+  World world(&GetGameDefinitions(kWorldCatalogItems));
+  world.Load(GetPlayerFile(state.range(0)));
+
+  std::string filename = (GetDataDirectory() / "saved.yaml").string();
+
+  bool flip = false;
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    world.SetName(flip ? "Bench" : "Bench2");
+    flip = !flip;
+
+    world.Save(filename);
+  }
+}
+BENCHMARK(BM_WorldSave)->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+void BM_DoubleMapFindId(benchmark::State& state) {
+  const DoubleMap<std::string>& items = GetGame(state.range(0)).GetItems();
+
+  size_t i = 0;
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(items.FindId(items.GetList()[i]));
+    i = (i + 1) % items.size();
+  }
+}
+BENCHMARK(BM_DoubleMapFindId)->Arg(1000)->Arg(20000);
+
+void BM_OrderedBijectionGetByValue(benchmark::State& state) {
+  const OrderedBijection<int, std::string>& choices =
+      GetGame(1000).GetOption("option_1").choices;
+  const std::vector<std::tuple<int, std::string>>& items = choices.GetItems();
+
+  size_t i = 0;
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(choices.GetByValue(std::get<1>(items[i])));
+    i = (i + 1) % items.size();
+  }
+}
+BENCHMARK(BM_OrderedBijectionGetByValue);
+
+constexpr std::string_view kRandomSpecifiers[] = {
+    "random",       "random-low",          "random-high",
+    "random-range-5-10", "random-range-middle-0-2147483647",
+    "random-sideways"};
+
+void BM_GetRandomOptionValueFromString(benchmark::State& state) {
+  size_t i = 0;
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        GetRandomOptionValueFromString(kRandomSpecifiers[i]));
+    i = (i + 1) % std::size(kRandomSpecifiers);
+  }
+}
+BENCHMARK(BM_GetRandomOptionValueFromString);
+
+void BM_ParseRandomSpecifier(benchmark::State& state) {
+  size_t i = 0;
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    std::string_view descriptor = kRandomSpecifiers[i];
+    benchmark::DoNotOptimize(descriptor);
+    benchmark::DoNotOptimize(ParseRandomSpecifier(descriptor));
+    i = (i + 1) % std::size(kRandomSpecifiers);
+  }
+}
+BENCHMARK(BM_ParseRandomSpecifier);
+
+void BM_FormatRandomOptionValue(benchmark::State& state) {
+  std::vector<OptionValue> values;
+  for (std::string_view descriptor : kRandomSpecifiers) {
+    values.push_back(GetRandomOptionValueFromString(descriptor));
+  }
+
+  size_t i = 0;
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FormatRandomOptionValue(values[i]));
+    i = (i + 1) % values.size();
+  }
+}
+BENCHMARK(BM_FormatRandomOptionValue);
+
+// Copies every option's default, as the editor and dialogs do when an option
+// isn't set.
+void BM_CopyDefaultValues(benchmark::State& state) {
+  const std::vector<OptionDefinition>& options =
+      GetGame(state.range(0)).GetOptions();
+
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    for (const OptionDefinition& option : options) {
+      OptionValue option_value = option.default_value;
+      benchmark::DoNotOptimize(option_value);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * options.size());
+}
+BENCHMARK(BM_CopyDefaultValues)->Arg(1000)->Arg(20000);
+
+void BM_FilterItems(benchmark::State& state) {
+  const std::vector<std::string>& locations =
+      GetGame(state.range(0)).GetLocations().GetList();
+
+  // One filter that matches a lot, one that matches a little and one that
+  // matches nothing, as the user would type them.
+  constexpr std::string_view kFilters[] = {"cave", "tower - boss 1",
+                                           "nowhere"};
+
+  size_t i = 0;
+  AllocationReporter allocations(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FilterItems(locations, kFilters[i]));
+    i = (i + 1) % std::size(kFilters);
+  }
+
+  state.SetItemsProcessed(state.iterations() * locations.size());
+}
+BENCHMARK(BM_FilterItems)->Arg(1000)->Arg(20000)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  // GameDefinitions logs each file it reads, which would drown the results.
+  std::clog.rdbuf(nullptr);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
@@ -0,0 +1,263 @@
+#include "synthetic_data.h"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <vector>
+
+#include "core_util.h"
+
+namespace {
+
+constexpr const char* kAdjectives[] = {"Progressive", "Small",  "Big",
+                                       "Golden",      "Rusty",  "Ancient",
+                                       "Magic",       "Hidden", "Broken"};
+
+constexpr const char* kNouns[] = {"Sword", "Shield", "Key",    "Bow",
+                                  "Bomb",  "Heart",  "Rupee",  "Boots",
+                                  "Map",   "Compass", "Bottle", "Hookshot"};
+
+constexpr const char* kPlaces[] = {"Forest", "Castle", "Lake",   "Tower",
+                                   "Desert", "Cave",   "Temple", "Village"};
+
+constexpr const char* kFeatures[] = {"Chest", "Pot", "Boss", "Shop", "Ledge",
+                                     "Grave", "Well"};
+
+template <size_t N>
+const char* Pick(const char* const (&words)[N], int index) {
+  return words[index % N];
+}
+
+std::string GetItemName(int index) {
+  return std::string(Pick(kAdjectives, index / 7)) + " " + Pick(kNouns, index) +
+         " " + std::to_string(index + 1);
+}
+
+std::string GetLocationName(int index) {
+  return std::string(Pick(kPlaces, index / 5)) + " - " +
+         Pick(kFeatures, index) + " " + std::to_string(index + 1);
+}
+
+nlohmann::ordered_json GenerateOption(int index) {
+  nlohmann::ordered_json option;
+  option["displayName"] = "Option " + std::to_string(index + 1);
+  option["description"] = "A generated option.";
+
+  switch (index % 8) {
+    case 0: {
+      option["type"] = "select";
+      option["options"] = nlohmann::ordered_json::array();
+      for (int i = 0; i < 5; i++) {
+        option["options"].push_back({{"id", i},
+                                     {"name", "Choice " + std::to_string(i)},
+                                     {"value", "choice_" + std::to_string(i)}});
+      }
+      option["defaultValue"] = "choice_0";
+      option["aliases"] = {{{"name", "first"}, {"value", "choice_0"}}};
+      break;
+    }
+    case 1: {
+      option["type"] = "range";
+      option["min"] = 0;
+      option["max"] = 100;
+      option["defaultValue"] = 50;
+      break;
+    }
+    case 2: {
+      option["type"] = "named_range";
+      option["min"] = 1;
+      option["max"] = 1000;
+      option["defaultValue"] = "normal";
+      option["value_names"] = {{"easy", 10}, {"normal", 100}, {"hard", 500}};
+      break;
+    }
+    case 3: {
+      option["type"] = "options-set";
+      option["options"] = nlohmann::ordered_json::array();
+      for (int i = 0; i < 10; i++) {
+        option["options"].push_back("Flag " + std::to_string(i));
+      }
+      option["defaultValue"] = {"Flag 0"};
+      break;
+    }
+    case 4: {
+      option["type"] = "items-set";
+      option["defaultValue"] = nlohmann::ordered_json::array();
+      break;
+    }
+    case 5: {
+      option["type"] = "items-dict";
+      option["defaultValue"] = nlohmann::ordered_json::array();
+      break;
+    }
+    case 6: {
+      option["type"] = "locations-set";
+      option["defaultValue"] = nlohmann::ordered_json::array();
+      break;
+    }
+    default: {
+      option["type"] = "select";
+      option["options"] = {{{"id", 0}, {"name", "No"}, {"value", "false"}},
+                           {{"id", 1}, {"name", "Yes"}, {"value", "true"}}};
+      option["defaultValue"] = "false";
+      option["aliases"] = nlohmann::ordered_json::array();
+      break;
+    }
+  }
+
+  return option;
+}
+
+void EmitOptionValue(YAML::Emitter& out, const Game& game,
+                     const OptionDefinition& option,
+                     const SyntheticWorldOptions& options,
+                     std::mt19937& random) {
+  if (option.type == kSelectOption) {
+    const auto& choices = option.choices.GetItems();
+    if (random() % 4 == 0) {
+      out << YAML::BeginMap;
+      for (const auto& [choice_id, choice_value] : choices) {
+        out << YAML::Key << choice_value << YAML::Value
+            << static_cast<int>(random() % 50);
+      }
+      out << YAML::EndMap;
+    } else {
+      out << std::get<1>(choices[random() % choices.size()]);
+    }
+  } else if (option.type == kRangeOption) {
+    int span = option.max_value - option.min_value + 1;
+    if (random() % 4 == 0) {
+      int low = option.min_value + random() % span;
+      int high = low + random() % (option.max_value - low + 1);
+      out << "random-range-" + std::to_string(low) + "-" +
+                 std::to_string(high);
+    } else {
+      out << option.min_value + static_cast<int>(random() % span);
+    }
+  } else if (option.type == kSetOption || option.type == kDictOption) {
+    const DoubleMap<std::string>& elements =
+        GetOptionSetElements(game, option.name);
+
+    std::vector<size_t> ids;
+    int count = std::min<int>(options.set_values, elements.size());
+    for (int i = 0; i < count; i++) {
+      ids.push_back(random() % elements.size());
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    if (option.type == kSetOption) {
+      out << YAML::BeginSeq;
+      for (size_t id : ids) {
+        out << elements.GetValue(id);
+      }
+      out << YAML::EndSeq;
+    } else {
+      out << YAML::BeginMap;
+      for (size_t id : ids) {
+        out << YAML::Key << elements.GetValue(id) << YAML::Value
+            << static_cast<int>(random() % 5 + 1);
+      }
+      out << YAML::EndMap;
+    }
+  } else {
+    out << YAML::Null;
+  }
+}
+
+}  // namespace
+
+std::string GenerateDumpedOptions(const SyntheticCatalogOptions& options) {
+  nlohmann::ordered_json all_games;
+
+  for (int game_index = 0; game_index < options.games; game_index++) {
+    nlohmann::ordered_json game;
+
+    game["items"] = nlohmann::ordered_json::array();
+    for (int i = 0; i < options.items; i++) {
+      game["items"].push_back(GetItemName(i));
+    }
+    game["itemGroups"] = nlohmann::ordered_json::array();
+    for (const char* noun : kNouns) {
+      game["itemGroups"].push_back(std::string(noun) + "s");
+    }
+
+    game["locations"] = nlohmann::ordered_json::array();
+    for (int i = 0; i < options.locations; i++) {
+      game["locations"].push_back(GetLocationName(i));
+    }
+    game["locationGroups"] = nlohmann::ordered_json::array();
+    for (const char* place : kPlaces) {
+      game["locationGroups"].push_back(place);
+    }
+
+    for (int i = 0; i < options.options; i++) {
+      game["options"]["option_" + std::to_string(i + 1)] =
+          GenerateOption(i);
+    }
+
+    game["commonOptions"] = {"local_items",     "non_local_items",
+                             "start_inventory", "start_hints",
+                             "exclude_locations", "priority_locations"};
+
+    game["presets"] = nlohmann::ordered_json::object();
+    for (int preset = 0; preset < options.presets; preset++) {
+      nlohmann::ordered_json values;
+      for (int i = 0; i < options.options; i++) {
+        if (i % 8 == 1) {
+          values["option_" + std::to_string(i + 1)] = preset * 10;
+        } else if (i % 8 == 0) {
+          values["option_" + std::to_string(i + 1)] =
+              "choice_" + std::to_string(preset % 5);
+        }
+      }
+
+      game["presets"]["Preset " + std::to_string(preset + 1)] =
+          std::move(values);
+    }
+
+    all_games["Game " + std::to_string(game_index + 1)] = std::move(game);
+  }
+
+  return all_games.dump();
+}
+
+std::string GeneratePlayerYaml(const Game& game,
+                               const SyntheticWorldOptions& options,
+                               unsigned seed) {
+  std::mt19937 random(seed);
+  std::string result;
+
+  for (int world = 0; world < options.worlds; world++) {
+    YAML::Emitter out;
+    out << YAML::BeginMap;
+    out << YAML::Key << "name" << YAML::Value
+        << "Player" + std::to_string(seed) + "_" + std::to_string(world + 1);
+    out << YAML::Key << "description" << YAML::Value << "A generated world.";
+    out << YAML::Key << "game" << YAML::Value << game.GetName();
+    out << YAML::Key << "requires" << YAML::Value << YAML::BeginMap
+        << YAML::Key << "version" << YAML::Value << "0.5.0" << YAML::EndMap;
+
+    out << YAML::Key << game.GetName() << YAML::Value << YAML::BeginMap;
+    for (const OptionDefinition& option : game.GetOptions()) {
+      if (option.type == kUNKNOWN_OPTION_TYPE) {
+        continue;
+      }
+
+      out << YAML::Key << option.name << YAML::Value;
+      EmitOptionValue(out, game, option, options, random);
+    }
+    out << YAML::EndMap;
+    out << YAML::EndMap;
+
+    if (world > 0) {
+      result.append("---\n");
+    }
+    result.append(out.c_str());
+    result.push_back('\n');
+  }
+
+  return result;
+}
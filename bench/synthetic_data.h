@@ -0,0 +1,32 @@
+#ifndef SYNTHETIC_DATA_H_C47E2A05
+#define SYNTHETIC_DATA_H_C47E2A05
+
+#include <string>
+
+#include "game_definition.h"
+
+struct SyntheticCatalogOptions {
+  int games = 1;
+  int options = 60;  // per game, cycling through every option type
+  int items = 1000;
+  int locations = 2000;
+  int presets = 4;
+};
+
+// Generates the text of a dumped-options.json. Games are named "Game 1",
+// "Game 2" and so on, and item and location names are made of a few common
+// words so that filtering them behaves like it does on real data.
+std::string GenerateDumpedOptions(const SyntheticCatalogOptions& options);
+
+struct SyntheticWorldOptions {
+  int set_values = 100;  // entries per set or dict option, at most
+  int worlds = 1;        // documents in the file
+};
+
+// Generates a player YAML that sets every option in the game to a valid
+// value. The same seed always gives the same file.
+std::string GeneratePlayerYaml(const Game& game,
+                               const SyntheticWorldOptions& options,
+                               unsigned seed);
+
+#endif /* end of include guard: SYNTHETIC_DATA_H_C47E2A05 */
@@ -0,0 +1,84 @@
+#include "allocation_counter.h"
+
+#ifdef AP_WIZARD_COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+
+#include "trace.h"
+
+namespace {
+
+// Plain data, so that it can be used before the thread's dynamic
+// initialisation has run.
+thread_local AllocationCounts thread_counts;
+
+void* CountedAllocate(size_t size) {
+  thread_counts.allocations++;
+  thread_counts.bytes += size;
+
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+}  // namespace
+
+// Over-aligned allocations keep the standard library's operators, and so
+// aren't counted.
+void* operator new(size_t size) {
+  if (void* result = CountedAllocate(size)) {
+    return result;
+  }
+
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return CountedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return CountedAllocate(size);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  std::free(pointer);
+}
+
+AllocationCounts GetThreadAllocationCounts() { return thread_counts; }
+
+AllocationProbe::AllocationProbe(const char* name)
+    : name_(name), start_counts_(GetThreadAllocationCounts()) {
+#ifdef AP_WIZARD_TRACE
+  if (trace_internal::IsEnabled()) {
+    start_time_ = trace_internal::GetTimestamp();
+  }
+#endif
+}
+
+AllocationProbe::~AllocationProbe() {
+#ifdef AP_WIZARD_TRACE
+  if (start_time_ >= 0) {
+    AllocationCounts counts = GetCounts();
+    trace_internal::RecordSpan(
+        name_, {}, start_time_, trace_internal::GetTimestamp(),
+        {{"allocations", static_cast<int64_t>(counts.allocations)},
+         {"bytes", static_cast<int64_t>(counts.bytes)}});
+  }
+#endif
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef ALLOCATION_COUNTER_H_B35F08C2
+#define ALLOCATION_COUNTER_H_B35F08C2
+
+// Counts the heap allocations made by each thread, by replacing the global
+// operator new. This is only compiled in when the build defines
+// AP_WIZARD_COUNT_ALLOCATIONS; otherwise ALLOCATION_PROBE does nothing.
+//
+//   void World::SetOption(...) {
+//     ALLOCATION_PROBE("Set option");
+//     ...
+//   }
+//
+// A probe reports how many allocations its scope made, and how many bytes
+// they asked for, as a span in the trace (see trace.h). Only the calling
+// thread's allocations are counted.
+
+#ifdef AP_WIZARD_COUNT_ALLOCATIONS
+
+#include <cstdint>
+
+struct AllocationCounts {
+  uint64_t allocations = 0;
+  uint64_t bytes = 0;
+
+  AllocationCounts operator-(const AllocationCounts& other) const {
+    return {allocations - other.allocations, bytes - other.bytes};
+  }
+};
+
+// Everything the calling thread has allocated since it started.
+AllocationCounts GetThreadAllocationCounts();
+
+class AllocationProbe {
+ public:
+  // The name must be a string literal.
+  explicit AllocationProbe(const char* name);
+
+  AllocationProbe(const AllocationProbe&) = delete;
+  AllocationProbe& operator=(const AllocationProbe&) = delete;
+
+  ~AllocationProbe();
+
+  // What the scope has allocated so far.
+  AllocationCounts GetCounts() const {
+    return GetThreadAllocationCounts() - start_counts_;
+  }
+
+ private:
+  // Only used when tracing is compiled in too.
+  [[maybe_unused]] const char* name_;
+  AllocationCounts start_counts_;
+  [[maybe_unused]] int64_t start_time_ = -1;
+};
+
+#define ALLOCATION_PROBE_CONCAT_INNER(a, b) a##b
+#define ALLOCATION_PROBE_CONCAT(a, b) ALLOCATION_PROBE_CONCAT_INNER(a, b)
+#define ALLOCATION_PROBE(name) \
+  AllocationProbe ALLOCATION_PROBE_CONCAT(allocation_probe_, __LINE__)(name)
+
+#else
+
+#define ALLOCATION_PROBE(name) ((void)0)
+
+#endif
+
+#endif /* end of include guard: ALLOCATION_COUNTER_H_B35F08C2 */
@@ -0,0 +1,302 @@
+#include "bulk_import.h"
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <charconv>
+#include <optional>
+
+#include "core_util.h"
+#include "yaml_outline.h"
+
+namespace {
+
+// Suggestions require a scan of the whole option set, so they are only
+// computed for the first few unknown names.
+constexpr size_t kMaxEntriesWithSuggestions = 50;
+constexpr size_t kMaxSuggestionsPerEntry = 3;
+
+std::string_view Unquote(std::string_view input) {
+  if (input.size() >= 2 && (input.front() == '"' || input.front() == '\'') &&
+      input.back() == input.front()) {
+    return input.substr(1, input.size() - 2);
+  }
+
+  return input;
+}
+
+std::optional<int> ParseAmount(std::string_view input) {
+  int result = 0;
+  const char* end = input.data() + input.size();
+  auto [ptr, ec] = std::from_chars(input.data(), end, result);
+  if (input.empty() || ec != std::errc() || ptr != end) {
+    return std::nullopt;
+  }
+
+  return result;
+}
+
+// Levenshtein distance that gives up as soon as it is known to exceed limit.
+size_t BoundedEditDistance(std::string_view lhs, std::string_view rhs,
+                           size_t limit) {
+  if ((lhs.size() > rhs.size() ? lhs.size() - rhs.size()
+                               : rhs.size() - lhs.size()) > limit) {
+    return limit + 1;
+  }
+
+  std::vector<size_t> row(rhs.size() + 1);
+  for (size_t j = 0; j <= rhs.size(); j++) {
+    row[j] = j;
+  }
+
+  for (size_t i = 1; i <= lhs.size(); i++) {
+    size_t diagonal = row[0];
+    row[0] = i;
+    size_t row_min = row[0];
+
+    for (size_t j = 1; j <= rhs.size(); j++) {
+      size_t above = row[j];
+      row[j] = std::min({row[j] + 1, row[j - 1] + 1,
+                         diagonal + (lhs[i - 1] == rhs[j - 1] ? 0 : 1)});
+      diagonal = above;
+      row_min = std::min(row_min, row[j]);
+    }
+
+    if (row_min > limit) {
+      return limit + 1;
+    }
+  }
+
+  return row[rhs.size()];
+}
+
+class BulkImportParser {
+ public:
+  explicit BulkImportParser(const DoubleMap<std::string>& option_set)
+      : option_set_(option_set) {}
+
+  void ParseLine(std::string_view line, int line_number) {
+    int indentation = GetIndentation(line);
+    line = Trim(line);
+    if (line.empty() || line.front() == '#' || line == "---") {
+      return;
+    }
+
+    // An unknown key without a value is a header, such as the option's own
+    // name, only if the lines after it are nested under it.
+    if (pending_header_) {
+      bool nested = indentation > pending_header_->indentation ||
+                    (indentation == pending_header_->indentation &&
+                     (line.starts_with("- ") || line == "-"));
+      if (!nested) {
+        AddUnknown(std::move(pending_header_->name), pending_header_->line);
+      }
+
+      pending_header_.reset();
+    }
+
+    if (line.starts_with("- ") || line == "-") {
+      line = Trim(line.substr(1));
+
+      if (line.empty()) {
+        return;
+      }
+    }
+
+    if (line.front() == '[' || line.front() == '{') {
+      ParseFlow(line, line_number);
+      return;
+    }
+
+    size_t colon = line.rfind(':');
+    if (colon != std::string_view::npos) {
+      std::string_view rest = Trim(line.substr(colon + 1));
+
+      if (rest.empty()) {
+        // Either a map key without a value, or the option's own header line,
+        // e.g. "start_inventory:".
+        AddEntry(line, 1, line_number, indentation);
+        return;
+      }
+
+      if (std::optional<int> amount = ParseAmount(rest)) {
+        AddEntry(Trim(line.substr(0, colon)), *amount, line_number);
+        return;
+      }
+
+      size_t header_colon = line.find(": ");
+      if (header_colon != std::string_view::npos) {
+        std::string_view value = Trim(line.substr(header_colon + 1));
+        if (!value.empty() && (value.front() == '[' || value.front() == '{')) {
+          ParseFlow(value, line_number);
+          return;
+        }
+      }
+    }
+
+    AddEntry(line, 1, line_number);
+  }
+
+  BulkImportResult TakeResult() {
+    if (pending_header_) {
+      AddUnknown(std::move(pending_header_->name), pending_header_->line);
+      pending_header_.reset();
+    }
+
+    AddSuggestions();
+
+    return std::move(result_);
+  }
+
+ private:
+  void ParseFlow(std::string_view text, int line_number) {
+    YAML::Node node;
+    try {
+      node = YAML::Load(std::string(text));
+    } catch (const std::exception&) {
+      AddEntry(text, 1, line_number);
+      return;
+    }
+
+    // Names and amounts are plain values; anything nested is left for the
+    // user to fix.
+    bool all_scalars = node.IsSequence() || node.IsMap();
+    for (YAML::const_iterator it = node.begin();
+         all_scalars && it != node.end(); it++) {
+      if (node.IsSequence()) {
+        all_scalars = it->IsScalar();
+      } else {
+        // A key without a value, as in "{Sword}", counts one.
+        all_scalars = it->first.IsScalar() &&
+                      (it->second.IsScalar() || it->second.IsNull());
+      }
+    }
+
+    if (!all_scalars) {
+      AddEntry(text, 1, line_number);
+    } else if (node.IsSequence()) {
+      for (const YAML::Node& value : node) {
+        AddEntry(value.as<std::string>(), 1, line_number);
+      }
+    } else {
+      for (YAML::const_iterator it = node.begin(); it != node.end(); it++) {
+        std::optional<int> amount = ParseAmount(it->second.as<std::string>());
+        AddEntry(it->first.as<std::string>(), amount.value_or(1), line_number);
+      }
+    }
+  }
+
+  // A header_indentation is given for keys without a value, which may be
+  // headers.
+  void AddEntry(std::string_view name, int amount, int line_number,
+                std::optional<int> header_indentation = std::nullopt) {
+    name = Unquote(name);
+
+    std::string key(name);
+    if (std::optional<size_t> id = option_set_.FindId(key)) {
+      result_.entries.emplace_back(*id, amount);
+      return;
+    }
+
+    if (header_indentation) {
+      std::string stripped(Unquote(Trim(name.substr(0, name.size() - 1))));
+
+      if (std::optional<size_t> id = option_set_.FindId(stripped)) {
+        result_.entries.emplace_back(*id, amount);
+      } else {
+        pending_header_ = {std::move(stripped), line_number,
+                           *header_indentation};
+      }
+
+      return;
+    }
+
+    AddUnknown(std::move(key), line_number);
+  }
+
+  void AddUnknown(std::string name, int line_number) {
+    UnknownImportEntry unknown;
+    unknown.name = std::move(name);
+    unknown.line = line_number;
+
+    result_.unknown.push_back(std::move(unknown));
+  }
+
+  void AddSuggestions() {
+    if (result_.unknown.empty()) {
+      return;
+    }
+
+    std::vector<std::string> lowered;
+    lowered.reserve(option_set_.size());
+    for (const std::string& value : option_set_.GetList()) {
+      lowered.push_back(ToLower(value));
+    }
+
+    size_t count =
+        std::min(result_.unknown.size(), kMaxEntriesWithSuggestions);
+    for (size_t i = 0; i < count; i++) {
+      UnknownImportEntry& unknown = result_.unknown[i];
+      std::string needle = ToLower(unknown.name);
+      size_t limit = std::max<size_t>(2, needle.size() / 3);
+
+      std::vector<std::tuple<size_t, size_t>> candidates;  // score, id
+      for (size_t id = 0; id < lowered.size(); id++) {
+        size_t score = BoundedEditDistance(needle, lowered[id], limit);
+
+        if (score > limit && !needle.empty() &&
+            lowered[id].find(needle) != std::string::npos) {
+          score = limit;
+        }
+
+        if (score <= limit) {
+          candidates.emplace_back(score, id);
+        }
+      }
+
+      size_t kept = std::min(candidates.size(), kMaxSuggestionsPerEntry);
+      std::partial_sort(candidates.begin(), candidates.begin() + kept,
+                        candidates.end());
+
+      for (size_t j = 0; j < kept; j++) {
+        unknown.suggestions.push_back(
+            option_set_.GetValue(std::get<1>(candidates[j])));
+      }
+    }
+  }
+
+  struct PendingHeader {
+    std::string name;
+    int line;
+    int indentation;
+  };
+
+  const DoubleMap<std::string>& option_set_;
+  BulkImportResult result_;
+
+  // An unknown key without a value, until the next line shows whether it is a
+  // header.
+  std::optional<PendingHeader> pending_header_;
+};
+
+}  // namespace
+
+BulkImportResult ParseBulkImport(const DoubleMap<std::string>& option_set,
+                                 std::string_view text) {
+  BulkImportParser parser(option_set);
+
+  int line_number = 1;
+  while (!text.empty()) {
+    size_t newline = text.find('\n');
+    parser.ParseLine(text.substr(0, newline), line_number);
+
+    if (newline == std::string_view::npos) {
+      break;
+    }
+
+    text.remove_prefix(newline + 1);
+    line_number++;
+  }
+
+  return parser.TakeResult();
+}
@@ -0,0 +1,29 @@
+#ifndef BULK_IMPORT_H_6C1F0A93
+#define BULK_IMPORT_H_6C1F0A93
+
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "double_map.h"
+
+struct UnknownImportEntry {
+  std::string name;
+  int line = 0;
+  std::vector<std::string> suggestions;
+};
+
+struct BulkImportResult {
+  std::vector<std::tuple<size_t, int>> entries;  // id, amount
+  std::vector<UnknownImportEntry> unknown;
+};
+
+// Parses a pasted list of values for a set or dict option. Each line may be a
+// bare name, a "name: count" pair, or a YAML block/flow list or map entry.
+// Every name is resolved against the option's values with one lookup; names
+// that cannot be resolved are reported along with near-match suggestions.
+BulkImportResult ParseBulkImport(const DoubleMap<std::string>& option_set,
+                                 std::string_view text);
+
+#endif /* end of include guard: BULK_IMPORT_H_6C1F0A93 */
@@ -0,0 +1,185 @@
+#include "completion_index.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "core_util.h"
+#include "game_definition.h"
+
+namespace {
+
+bool IsWordStart(const std::string& value, size_t offset) {
+  if (offset == 0) {
+    return true;
+  }
+
+  unsigned char prev = value[offset - 1];
+  unsigned char cur = value[offset];
+  return !std::isalnum(prev) && std::isalnum(cur);
+}
+
+}  // namespace
+
+CompletionIndex::CompletionIndex(std::vector<std::string> values)
+    : values_(std::move(values)) {
+  lowered_.reserve(values_.size());
+  for (const std::string& value : values_) {
+    lowered_.push_back(ToLower(value));
+  }
+
+  for (uint32_t i = 0; i < lowered_.size(); i++) {
+    for (uint32_t offset = 0; offset < lowered_[i].size(); offset++) {
+      if (IsWordStart(lowered_[i], offset)) {
+        keys_.emplace_back(i, offset);
+      }
+    }
+  }
+
+  auto key_text = [this](const std::tuple<uint32_t, uint32_t>& key) {
+    return std::string_view(lowered_[std::get<0>(key)])
+        .substr(std::get<1>(key));
+  };
+
+  std::sort(keys_.begin(), keys_.end(),
+            [&key_text](const auto& lhs, const auto& rhs) {
+              return key_text(lhs) < key_text(rhs);
+            });
+}
+
+std::vector<std::string_view> CompletionIndex::Find(std::string_view prefix,
+                                                    size_t max_results) const {
+  std::string needle = ToLower(prefix);
+
+  auto key_text = [this](const std::tuple<uint32_t, uint32_t>& key) {
+    return std::string_view(lowered_[std::get<0>(key)])
+        .substr(std::get<1>(key));
+  };
+
+  auto it = std::lower_bound(
+      keys_.begin(), keys_.end(), needle,
+      [&key_text](const auto& key, const std::string& value) {
+        return key_text(key) < value;
+      });
+
+  // Rank by: matches at the start of the value, shorter values (closer to
+  // what has been typed), matches that also agree in case, then original
+  // order.
+  using Candidate = std::tuple<bool, size_t, bool, uint32_t>;
+  std::vector<Candidate> candidates;
+  for (; it != keys_.end() && key_text(*it).starts_with(needle); it++) {
+    const auto& [index, offset] = *it;
+    std::string_view original =
+        std::string_view(values_[index]).substr(offset, prefix.size());
+
+    candidates.emplace_back(offset != 0, values_[index].size(),
+                            original != prefix, index);
+  }
+
+  // Short prefixes can match most of a large table, so only the best few
+  // candidates are pulled off a heap rather than sorting all of them. A value
+  // can match at more than one word start; only its best match is kept.
+  auto worse = [](const Candidate& lhs, const Candidate& rhs) {
+    return lhs > rhs;
+  };
+  std::make_heap(candidates.begin(), candidates.end(), worse);
+
+  std::vector<uint32_t> chosen;
+  while (!candidates.empty() && chosen.size() < max_results) {
+    std::pop_heap(candidates.begin(), candidates.end(), worse);
+    uint32_t index = std::get<3>(candidates.back());
+    candidates.pop_back();
+
+    if (std::find(chosen.begin(), chosen.end(), index) == chosen.end()) {
+      chosen.push_back(index);
+    }
+  }
+
+  std::vector<std::string_view> result;
+  result.reserve(chosen.size());
+  for (uint32_t index : chosen) {
+    result.push_back(values_[index]);
+  }
+
+  return result;
+}
+
+GameCompletions::GameCompletions(const Game& game)
+    : game_(&game),
+      items_(CompletionIndex(game.GetItems().GetList())),
+      locations_(CompletionIndex(game.GetLocations().GetList())) {
+  std::vector<std::string> option_names;
+
+  for (const OptionDefinition& option : game.GetOptions()) {
+    option_names.push_back(option.name);
+
+    std::vector<std::string> values;
+    if (option.type == kSelectOption) {
+      for (const auto& [choice_id, choice_value] : option.choices.GetItems()) {
+        values.push_back(choice_value);
+      }
+      for (const auto& [alias, aliased] : option.aliases) {
+        values.push_back(alias);
+      }
+
+      values.push_back("random");
+    } else if (option.type == kRangeOption) {
+      for (const auto& [value_value, value_name] :
+           option.value_names.GetItems()) {
+        values.push_back(value_name);
+      }
+
+      values.push_back("random");
+      values.push_back("random-low");
+      values.push_back("random-middle");
+      values.push_back("random-high");
+      values.push_back("random-range-");
+      values.push_back("random-range-low-");
+      values.push_back("random-range-middle-");
+      values.push_back("random-range-high-");
+    } else if (option.set_type == kCustomSet) {
+      custom_sets_.emplace(option.name,
+                           CompletionIndex(option.custom_set.GetList()));
+    }
+
+    if (!values.empty()) {
+      option_values_.emplace(option.name, CompletionIndex(std::move(values)));
+    }
+  }
+
+  option_names_ = CompletionIndex(std::move(option_names));
+}
+
+const CompletionIndex* GameCompletions::GetOptionValues(
+    const std::string& option_name) const {
+  auto it = option_values_.find(option_name);
+  if (it == option_values_.end()) {
+    return nullptr;
+  }
+
+  return &it->second;
+}
+
+const CompletionIndex* GameCompletions::GetSetValues(
+    const std::string& option_name) const {
+  if (!game_->HasOption(option_name)) {
+    return nullptr;
+  }
+
+  const OptionDefinition& option = game_->GetOption(option_name);
+  if (option.type != kSetOption && option.type != kDictOption) {
+    return nullptr;
+  }
+
+  if (option.set_type == kItemSet) {
+    return &items_;
+  } else if (option.set_type == kLocationSet) {
+    return &locations_;
+  } else if (option.set_type == kCustomSet) {
+    auto it = custom_sets_.find(option_name);
+    if (it != custom_sets_.end()) {
+      return &it->second;
+    }
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,61 @@
+#ifndef COMPLETION_INDEX_H_7B3D90E2
+#define COMPLETION_INDEX_H_7B3D90E2
+
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+class Game;
+
+// Sorted, case-insensitive prefix index over a list of strings. Every word
+// start is indexed, so "sword" finds "Progressive Sword", although matches at
+// the start of a value are ranked first.
+class CompletionIndex {
+ public:
+  CompletionIndex() = default;
+
+  explicit CompletionIndex(std::vector<std::string> values);
+
+  // Returns up to max_results values starting with (or containing a word
+  // starting with) the given prefix, most likely completion first.
+  std::vector<std::string_view> Find(std::string_view prefix,
+                                     size_t max_results) const;
+
+  size_t size() const { return values_.size(); }
+
+ private:
+  std::vector<std::string> values_;
+  std::vector<std::string> lowered_;
+  std::vector<std::tuple<uint32_t, uint32_t>> keys_;  // value index, offset
+};
+
+// Completion indices for everything that can be typed into a game's section
+// of a YAML file. Built once per game.
+class GameCompletions {
+ public:
+  explicit GameCompletions(const Game& game);
+
+  const CompletionIndex& GetOptionNames() const { return option_names_; }
+
+  // Choice names and aliases for select options, value names for named
+  // ranges, and random specifiers. Returns nullptr for unknown options.
+  const CompletionIndex* GetOptionValues(const std::string& option_name) const;
+
+  // Items, locations or custom values, depending on the option's set type.
+  // Returns nullptr for options that aren't sets or dicts.
+  const CompletionIndex* GetSetValues(const std::string& option_name) const;
+
+ private:
+  const Game* game_;
+
+  CompletionIndex option_names_;
+  CompletionIndex items_;
+  CompletionIndex locations_;
+  std::map<std::string, CompletionIndex> option_values_;
+  std::map<std::string, CompletionIndex> custom_sets_;
+};
+
+#endif /* end of include guard: COMPLETION_INDEX_H_7B3D90E2 */
@@ -0,0 +1,54 @@
+#ifndef COPY_ON_WRITE_H_9C41D6E2
+#define COPY_ON_WRITE_H_9C41D6E2
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// A value that is shared between copies until one of them is changed, so that
+// copying it only copies a pointer. An empty handle reads as a
+// default-constructed T without allocating one.
+//
+// Like any other value, a handle must not be changed while another thread is
+// reading it; distinct handles sharing a payload may be used from different
+// threads.
+template <typename T>
+class CopyOnWrite {
+ public:
+  CopyOnWrite() = default;
+
+  explicit CopyOnWrite(T value)
+      : value_(std::make_shared<T>(std::move(value))) {}
+
+  const T& operator*() const { return value_ ? *value_ : GetEmpty(); }
+
+  const T* operator->() const { return &**this; }
+
+  // Copies the payload first if any other handle shares it.
+  T& Mutable() {
+    if (!value_) {
+      value_ = std::make_shared<T>();
+    } else if (value_.use_count() > 1) {
+      value_ = std::make_shared<T>(*value_);
+    }
+
+    return *value_;
+  }
+
+  // How many handles share the payload, or 0 if there isn't one.
+  size_t GetShareCount() const { return value_ ? value_.use_count() : 0; }
+
+  bool operator==(const CopyOnWrite& other) const {
+    return value_ == other.value_ || **this == *other;
+  }
+
+ private:
+  static const T& GetEmpty() {
+    static const T empty;
+    return empty;
+  }
+
+  std::shared_ptr<T> value_;
+};
+
+#endif /* end of include guard: COPY_ON_WRITE_H_9C41D6E2 */
@@ -0,0 +1,84 @@
+#include "core_util.h"
+
+#include <whereami.h>
+
+#include <stdexcept>
+
+OptionValue GetRandomOptionValueFromString(std::string_view descriptor) {
+  RandomSpecifier specifier = ParseRandomSpecifier(descriptor);
+
+  OptionValue result;
+  result.random = specifier.random;
+  result.range_random_type = specifier.type;
+  result.range_subset = specifier.range;
+
+  if (specifier.error) {
+    Diagnostic diagnostic;
+    diagnostic.code = *specifier.error;
+    diagnostic.value = std::string(descriptor);
+
+    result.errors.push_back(std::move(diagnostic));
+  }
+
+  return result;
+}
+
+RandomSpecifierText FormatRandomOptionValue(const OptionValue& option_value) {
+  return FormatRandomSpecifier(option_value.range_random_type,
+                               option_value.range_subset);
+}
+
+std::string RandomOptionValueToString(const OptionValue& option_value) {
+  return std::string(FormatRandomOptionValue(option_value).view());
+}
+
+const DoubleMap<std::string>& GetOptionSetElements(
+    const Game& game, const std::string& option_name) {
+  const OptionDefinition& game_option = game.GetOption(option_name);
+
+  if (game_option.set_type == kCustomSet) {
+    return game_option.custom_set;
+  } else if (game_option.set_type == kItemSet) {
+    return game.GetItems();
+  } else if (game_option.set_type == kLocationSet) {
+    return game.GetLocations();
+  }
+
+  throw std::invalid_argument("Invalid option set type.");
+}
+
+const std::filesystem::path& GetExecutableDirectory() {
+  static const std::filesystem::path* executable_directory = []() {
+    int length = wai_getExecutablePath(NULL, 0, NULL);
+    std::string buf(length, 0);
+    wai_getExecutablePath(buf.data(), length, NULL);
+
+    std::filesystem::path exec_path(buf);
+    return new std::filesystem::path(exec_path.parent_path());
+  }();
+
+  return *executable_directory;
+}
+
+std::string GetAbsolutePath(std::string_view path) {
+  return (GetExecutableDirectory() / path).string();
+}
+
+std::string ToLower(std::string_view input) {
+  std::string result(input);
+  for (char& ch : result) {
+    ch = std::tolower(static_cast<unsigned char>(ch));
+  }
+
+  return result;
+}
+
+std::string_view Trim(std::string_view input) {
+  size_t first = input.find_first_not_of(" \t\r\n");
+  if (first == std::string_view::npos) {
+    return {};
+  }
+
+  size_t last = input.find_last_not_of(" \t\r\n");
+  return input.substr(first, last - first + 1);
+}
@@ -0,0 +1,37 @@
+#ifndef CORE_UTIL_H_5F2C81D7
+#define CORE_UTIL_H_5F2C81D7
+
+#include <cctype>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "double_map.h"
+#include "game_definition.h"
+#include "random_specifier.h"
+
+OptionValue GetRandomOptionValueFromString(std::string_view descriptor);
+
+// Formats without allocating; the text lives in the returned value.
+RandomSpecifierText FormatRandomOptionValue(const OptionValue& option_value);
+
+std::string RandomOptionValueToString(const OptionValue& option_value);
+
+const DoubleMap<std::string>& GetOptionSetElements(
+    const Game& game, const std::string& option_name);
+
+const std::filesystem::path& GetExecutableDirectory();
+
+std::string GetAbsolutePath(std::string_view path);
+
+// Inline, as the item filter calls it for every character it compares.
+inline char ToLower(char ch) {
+  return std::tolower(static_cast<unsigned char>(ch));
+}
+
+std::string ToLower(std::string_view input);
+
+// Strips spaces, tabs and line breaks from both ends.
+std::string_view Trim(std::string_view input);
+
+#endif /* end of include guard: CORE_UTIL_H_5F2C81D7 */
@@ -0,0 +1,72 @@
+#include "diagnostic.h"
+
+namespace {
+
+std::string Quote(const std::string& value) { return "\"" + value + "\""; }
+
+}  // namespace
+
+std::string FormatDiagnostic(const Diagnostic& diagnostic) {
+  switch (diagnostic.code) {
+    case DiagnosticCode::kUnknownChoice: {
+      return "Unknown value " + Quote(diagnostic.value) + ".";
+    }
+    case DiagnosticCode::kUnknownChoiceId: {
+      return "Unknown ID " + Quote(diagnostic.value) + ".";
+    }
+    case DiagnosticCode::kValueTooSmall: {
+      return "Value " + diagnostic.value + " is too small.";
+    }
+    case DiagnosticCode::kValueTooLarge: {
+      return "Value " + diagnostic.value + " is too large.";
+    }
+    case DiagnosticCode::kInvalidRangeValue:
+    case DiagnosticCode::kInvalidSetValue: {
+      return "Invalid value " + Quote(diagnostic.value) + ".";
+    }
+    case DiagnosticCode::kNonNumericWeight: {
+      return "Weight value " + Quote(diagnostic.value) + " is not numeric.";
+    }
+    case DiagnosticCode::kExpectedList: {
+      return "Option value should be a list.";
+    }
+    case DiagnosticCode::kExpectedMap: {
+      return "Option value should be a map.";
+    }
+    case DiagnosticCode::kRandomMissingBounds: {
+      return "Ranged random specifier " + Quote(diagnostic.value) +
+             " missing min and max values.";
+    }
+    case DiagnosticCode::kRandomMissingMax: {
+      return "Ranged random specifier " + Quote(diagnostic.value) +
+             " missing max value.";
+    }
+    case DiagnosticCode::kRandomMinNotNumeric: {
+      return "Ranged random specifier " + Quote(diagnostic.value) +
+             " min value is not numeric.";
+    }
+    case DiagnosticCode::kRandomMaxNotNumeric: {
+      return "Ranged random specifier " + Quote(diagnostic.value) +
+             " max value is not numeric.";
+    }
+    case DiagnosticCode::kMalformedRandom: {
+      return "Malformed random specifier " + Quote(diagnostic.value) + ".";
+    }
+  }
+
+  return "Unknown error.";
+}
+
+std::string FormatDiagnostics(const std::vector<Diagnostic>& diagnostics) {
+  std::string result;
+
+  for (const Diagnostic& diagnostic : diagnostics) {
+    if (!result.empty()) {
+      result.push_back('\n');
+    }
+
+    result.append(FormatDiagnostic(diagnostic));
+  }
+
+  return result;
+}
@@ -0,0 +1,46 @@
+#ifndef DIAGNOSTIC_H_61C0E4A8
+#define DIAGNOSTIC_H_61C0E4A8
+
+#include <string>
+#include <vector>
+
+struct OptionDefinition;
+
+enum class DiagnosticCode {
+  kUnknownChoice,
+  kUnknownChoiceId,
+  kValueTooSmall,
+  kValueTooLarge,
+  kInvalidRangeValue,
+  kNonNumericWeight,
+  kInvalidSetValue,
+  kExpectedList,
+  kExpectedMap,
+  kRandomMissingBounds,
+  kRandomMissingMax,
+  kRandomMinNotNumeric,
+  kRandomMaxNotNumeric,
+  kMalformedRandom,
+};
+
+// A problem found while reading an option's value. Only the pieces are
+// stored; the message is put together by FormatDiagnostic when something
+// actually shows it.
+struct Diagnostic {
+  DiagnosticCode code;
+  const OptionDefinition* option = nullptr;  // null if not known
+  std::string value;                         // the offending value, as written
+
+  // Zero-indexed position in the source document, or -1 if not known.
+  int line = -1;
+  int column = -1;
+
+  bool operator==(const Diagnostic&) const = default;
+};
+
+std::string FormatDiagnostic(const Diagnostic& diagnostic);
+
+// Formats each diagnostic on its own line.
+std::string FormatDiagnostics(const std::vector<Diagnostic>& diagnostics);
+
+#endif /* end of include guard: DIAGNOSTIC_H_61C0E4A8 */
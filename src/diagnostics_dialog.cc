@@ -0,0 +1,180 @@
+#include "diagnostics_dialog.h"
+
+#include <wx/listctrl.h>
+#include <wx/notebook.h>
+
+#include <string>
+
+#include "memory_usage.h"
+#include "timing_stats.h"
+#include "util.h"
+#include "window_pool.h"
+#include "world.h"
+#include "world_window.h"
+
+namespace {
+
+constexpr int kRefreshMilliseconds = 1000;
+
+using Row = std::vector<wxString>;
+
+wxListView* CreateList(wxWindow* parent,
+                       const std::vector<wxString>& columns) {
+  wxListView* list = new wxListView(parent, wxID_ANY, wxDefaultPosition,
+                                    wxDefaultSize, wxLC_REPORT);
+
+  for (const wxString& column : columns) {
+    list->AppendColumn(column);
+  }
+
+  return list;
+}
+
+// Updates the rows in place, so that the list doesn't flicker or lose its
+// scroll position when it's refreshed.
+void SetRows(wxListView* list, const std::vector<Row>& rows) {
+  while (list->GetItemCount() > static_cast<int>(rows.size())) {
+    list->DeleteItem(list->GetItemCount() - 1);
+  }
+
+  for (size_t i = 0; i < rows.size(); i++) {
+    if (static_cast<int>(i) >= list->GetItemCount()) {
+      list->InsertItem(i, rows[i][0]);
+    }
+
+    for (size_t column = 0; column < rows[i].size(); column++) {
+      if (list->GetItemText(i, column) != rows[i][column]) {
+        list->SetItem(i, column, rows[i][column]);
+      }
+    }
+  }
+}
+
+void FitColumns(wxListView* list) {
+  for (int column = 0; column < list->GetColumnCount(); column++) {
+    list->SetColumnWidth(column, wxLIST_AUTOSIZE_USEHEADER);
+  }
+}
+
+wxString FormatBytes(size_t bytes) {
+  if (bytes < 1024) {
+    return wxString::Format("%zu B", bytes);
+  } else if (bytes < 1024 * 1024) {
+    return wxString::Format("%.1f KB", bytes / 1024.0);
+  } else {
+    return wxString::Format("%.1f MB", bytes / (1024.0 * 1024.0));
+  }
+}
+
+wxString FormatMilliseconds(double milliseconds) {
+  return wxString::Format("%.1f ms", milliseconds);
+}
+
+}  // namespace
+
+DiagnosticsDialog::DiagnosticsDialog(
+    wxWindow* parent, const GameDefinitions* game_definitions,
+    const std::vector<std::unique_ptr<World>>* worlds,
+    const WorldWindow* world_window)
+    : wxDialog(parent, wxID_ANY, "Diagnostics", wxDefaultPosition,
+               wxSize(640, 480), wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
+      game_definitions_(game_definitions),
+      worlds_(worlds),
+      world_window_(world_window),
+      timer_(this) {
+  wxNotebook* notebook = new wxNotebook(this, wxID_ANY);
+
+  timings_list_ = CreateList(
+      notebook, {"Operation", "Count", "Last", "Mean", "Max", "Recent"});
+  games_list_ =
+      CreateList(notebook, {"Game", "Options", "Items", "Locations",
+                            "Presets", "Strings", "Total"});
+  worlds_list_ = CreateList(notebook, {"World", "Game", "File", "Memory"});
+  pools_list_ = CreateList(notebook, {"Pool", "Pooled", "In use"});
+
+  notebook->AddPage(timings_list_, "Timings", true);
+  notebook->AddPage(games_list_, "Games");
+  notebook->AddPage(worlds_list_, "Worlds");
+  notebook->AddPage(pools_list_, "Widgets");
+
+  wxBoxSizer* top_sizer = new wxBoxSizer(wxVERTICAL);
+  top_sizer->Add(notebook, wxSizerFlags().DoubleBorder().Proportion(1).Expand());
+  top_sizer->Add(CreateButtonSizer(wxCLOSE),
+                 wxSizerFlags().DoubleBorder(wxALL & ~wxUP).Expand());
+  SetSizer(top_sizer);
+
+  SetEscapeId(wxID_CLOSE);
+
+  // The option data doesn't change while the wizard is running.
+  PopulateGames();
+  UpdateLists();
+
+  Bind(wxEVT_TIMER, &DiagnosticsDialog::OnTimer, this);
+  timer_.Start(kRefreshMilliseconds);
+}
+
+void DiagnosticsDialog::PopulateGames() {
+  std::vector<Row> rows;
+
+  for (const std::string& game_name : game_definitions_->GetAllGames()) {
+    GameMemoryUsage usage =
+        GetMemoryUsage(game_definitions_->GetGame(game_name));
+
+    rows.push_back({game_name, FormatBytes(usage.options),
+                    FormatBytes(usage.items), FormatBytes(usage.locations),
+                    FormatBytes(usage.presets), FormatBytes(usage.strings),
+                    FormatBytes(usage.GetTotal())});
+  }
+
+  SetRows(games_list_, rows);
+  FitColumns(games_list_);
+}
+
+void DiagnosticsDialog::UpdateLists() {
+  std::vector<Row> timing_rows;
+  for (const TimingSummary& summary : GetTimingSummaries()) {
+    std::vector<wxString> recent;
+    for (double milliseconds : summary.recent_milliseconds) {
+      recent.push_back(wxString::Format("%.1f", milliseconds));
+    }
+
+    if (summary.count == 0) {
+      timing_rows.push_back(
+          {GetTimedOperationName(summary.operation), "0", "", "", "", ""});
+    } else {
+      timing_rows.push_back({GetTimedOperationName(summary.operation),
+                             wxString::Format("%zu", summary.count),
+                             FormatMilliseconds(summary.last_milliseconds),
+                             FormatMilliseconds(summary.mean_milliseconds),
+                             FormatMilliseconds(summary.max_milliseconds),
+                             implode(recent, ", ")});
+    }
+  }
+  SetRows(timings_list_, timing_rows);
+
+  std::vector<Row> world_rows;
+  for (const std::unique_ptr<World>& world : *worlds_) {
+    world_rows.push_back(
+        {world->GetName(), world->HasGame() ? world->GetGame() : "",
+         world->HasFilename() ? world->GetFilename() : "",
+         FormatBytes(world->GetMemoryUsage())});
+  }
+  SetRows(worlds_list_, world_rows);
+
+  std::vector<Row> pool_rows;
+  for (const WindowPoolStats& stats : world_window_->GetWindowPoolStats()) {
+    pool_rows.push_back({stats.name, wxString::Format("%zu", stats.pooled),
+                         wxString::Format("%zu", stats.used)});
+  }
+  SetRows(pools_list_, pool_rows);
+
+  FitColumns(timings_list_);
+  FitColumns(worlds_list_);
+  FitColumns(pools_list_);
+}
+
+void DiagnosticsDialog::OnTimer(wxTimerEvent&) {
+  if (IsShown()) {
+    UpdateLists();
+  }
+}
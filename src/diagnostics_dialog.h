@@ -0,0 +1,47 @@
+#ifndef DIAGNOSTICS_DIALOG_H_4E8B1D76
+#define DIAGNOSTICS_DIALOG_H_4E8B1D76
+
+#include <wx/wxprec.h>
+
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+#include <wx/timer.h>
+
+#include <memory>
+#include <vector>
+
+#include "game_definition.h"
+
+class wxListView;
+class World;
+class WorldWindow;
+
+// Shows how long recent operations took and roughly how much memory each
+// game and world uses, refreshing itself while it is open.
+class DiagnosticsDialog : public wxDialog {
+ public:
+  DiagnosticsDialog(wxWindow* parent, const GameDefinitions* game_definitions,
+                    const std::vector<std::unique_ptr<World>>* worlds,
+                    const WorldWindow* world_window);
+
+ private:
+  void PopulateGames();
+  void UpdateLists();
+
+  void OnTimer(wxTimerEvent& event);
+
+  const GameDefinitions* game_definitions_;
+  const std::vector<std::unique_ptr<World>>* worlds_;
+  const WorldWindow* world_window_;
+
+  wxListView* timings_list_;
+  wxListView* games_list_;
+  wxListView* worlds_list_;
+  wxListView* pools_list_;
+
+  wxTimer timer_;
+};
+
+#endif /* end of include guard: DIAGNOSTICS_DIALOG_H_4E8B1D76 */
@@ -1,7 +1,8 @@
 #ifndef DOUBLE_MAP_H_545C60BC
 #define DOUBLE_MAP_H_545C60BC
 
-#include <map>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 
 template <typename T>
@@ -16,6 +17,17 @@ class DoubleMap {
 
   size_t GetId(const T& value) const { return backward_.at(value); }
 
+  // Single hashed lookup, for callers that would otherwise have to call
+  // HasValue followed by GetId.
+  std::optional<size_t> FindId(const T& value) const {
+    auto it = backward_.find(value);
+    if (it == backward_.end()) {
+      return std::nullopt;
+    }
+
+    return it->second;
+  }
+
   const T& GetValue(size_t id) const { return forward_.at(id); }
 
   size_t size() const { return forward_.size(); }
@@ -24,7 +36,7 @@ class DoubleMap {
 
  private:
   std::vector<T> forward_;
-  std::map<T, size_t> backward_;
+  std::unordered_map<T, size_t> backward_;
 };
 
 #endif /* end of include guard: DOUBLE_MAP_H_545C60BC */
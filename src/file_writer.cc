@@ -0,0 +1,246 @@
+#include "file_writer.h"
+
+#include <fcntl.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "timing_stats.h"
+#include "trace.h"
+
+namespace {
+
+#ifdef _WIN32
+constexpr int kTempFileFlags =
+    _O_WRONLY | _O_CREAT | _O_EXCL | _O_TRUNC | _O_BINARY;
+
+int OpenTempFile(const std::string& filename) {
+  return _open(filename.c_str(), kTempFileFlags, _S_IREAD | _S_IWRITE);
+}
+
+int WriteToFile(int fd, const char* data, size_t size) {
+  return _write(fd, data, static_cast<unsigned int>(size));
+}
+
+int SyncToDisk(int fd) { return _commit(fd); }
+
+int CloseTempFile(int fd) { return _close(fd); }
+#else
+constexpr int kTempFileFlags = O_WRONLY | O_CREAT | O_EXCL | O_TRUNC;
+
+int OpenTempFile(const std::string& filename) {
+  return open(filename.c_str(), kTempFileFlags, 0644);
+}
+
+ssize_t WriteToFile(int fd, const char* data, size_t size) {
+  return write(fd, data, size);
+}
+
+int SyncToDisk(int fd) { return fsync(fd); }
+
+int CloseTempFile(int fd) { return close(fd); }
+
+// Makes the rename itself durable. This is best-effort; not every filesystem
+// allows syncing a directory.
+void SyncDirectory(const std::filesystem::path& directory) {
+  int fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    fsync(fd);
+    close(fd);
+  }
+}
+#endif
+
+// A leftover temporary file from a crash, or another instance saving the
+// same file, would make a predictable name collide, so the name is random and
+// a new one is tried if it exists anyway.
+constexpr int kMaxTempFileAttempts = 16;
+
+std::string GetTempFilename(const std::string& filename) {
+  thread_local std::mt19937_64 generator(std::random_device{}());
+
+  char suffix[32];
+  std::snprintf(suffix, sizeof(suffix), ".%016llx.tmp",
+                static_cast<unsigned long long>(generator()));
+
+  return filename + suffix;
+}
+
+[[noreturn]] void ThrowFileError(const std::string& action,
+                                 const std::string& filename, int error) {
+  std::string message = "Could not ";
+  message += action;
+  message += " \"";
+  message += filename;
+  message += "\": ";
+  message += std::strerror(error);
+
+  throw std::runtime_error(message);
+}
+
+}  // namespace
+
+void WriteFileAtomically(const std::string& filename,
+                         std::string_view contents) {
+  TRACE_SPAN("WriteFileAtomically", filename);
+  ScopedTiming timing(TimedOperation::kFileSave);
+
+  std::string temp_filename;
+  int fd = -1;
+  for (int attempt = 0; attempt < kMaxTempFileAttempts && fd < 0; attempt++) {
+    temp_filename = GetTempFilename(filename);
+    fd = OpenTempFile(temp_filename);
+
+    if (fd < 0 && errno != EEXIST) {
+      break;
+    }
+  }
+
+  if (fd < 0) {
+    ThrowFileError("create", temp_filename, errno);
+  }
+
+  auto fail = [fd, &temp_filename](const std::string& action) {
+    int error = errno;
+    CloseTempFile(fd);
+
+    std::error_code ec;
+    std::filesystem::remove(temp_filename, ec);
+
+    ThrowFileError(action, temp_filename, error);
+  };
+
+  const char* data = contents.data();
+  size_t remaining = contents.size();
+  while (remaining > 0) {
+    auto written = WriteToFile(fd, data, remaining);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      fail("write");
+    }
+
+    data += written;
+    remaining -= written;
+  }
+
+  if (SyncToDisk(fd) != 0) {
+    fail("flush");
+  }
+
+  if (CloseTempFile(fd) != 0) {
+    int error = errno;
+    std::error_code ec;
+    std::filesystem::remove(temp_filename, ec);
+
+    ThrowFileError("close", temp_filename, error);
+  }
+
+  // Keep the permissions of the file being replaced.
+  std::error_code ec;
+  std::filesystem::file_status status = std::filesystem::status(filename, ec);
+  if (!ec && std::filesystem::exists(status)) {
+    std::filesystem::permissions(temp_filename, status.permissions(), ec);
+  }
+
+  std::filesystem::rename(temp_filename, filename, ec);
+  if (ec) {
+    std::error_code remove_ec;
+    std::filesystem::remove(temp_filename, remove_ec);
+
+    std::string message = "Could not replace \"";
+    message += filename;
+    message += "\": ";
+    message += ec.message();
+
+    throw std::runtime_error(message);
+  }
+
+#ifndef _WIN32
+  SyncDirectory(std::filesystem::path(filename).parent_path());
+#endif
+}
+
+BackgroundFileWriter::BackgroundFileWriter() {
+  thread_ = std::thread([this] { Run(); });
+}
+
+BackgroundFileWriter::~BackgroundFileWriter() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+
+  job_cv_.notify_one();
+  thread_.join();
+}
+
+void BackgroundFileWriter::Submit(std::string filename,
+                                  std::shared_ptr<const std::string> contents,
+                                  Callback callback) {
+  {
+    std::lock_guard lock(mutex_);
+    jobs_.push_back(
+        {std::move(filename), std::move(contents), std::move(callback)});
+  }
+
+  job_cv_.notify_one();
+}
+
+void BackgroundFileWriter::Drain() {
+  std::unique_lock lock(mutex_);
+  idle_cv_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+}
+
+void BackgroundFileWriter::Run() {
+  for (;;) {
+    Job job;
+
+    {
+      std::unique_lock lock(mutex_);
+      job_cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+
+      // Outstanding writes are still finished when stopping, so that nothing
+      // the user saved is lost.
+      if (jobs_.empty()) {
+        return;
+      }
+
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+      busy_ = true;
+    }
+
+    std::optional<std::string> error;
+    try {
+      WriteFileAtomically(job.filename, *job.contents);
+    } catch (const std::exception& ex) {
+      error = ex.what();
+    }
+
+    if (job.callback) {
+      job.callback(std::move(error));
+    }
+
+    {
+      std::lock_guard lock(mutex_);
+      busy_ = false;
+    }
+
+    idle_cv_.notify_all();
+  }
+}
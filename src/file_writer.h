@@ -0,0 +1,62 @@
+#ifndef FILE_WRITER_H_5C81A2F3
+#define FILE_WRITER_H_5C81A2F3
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Replaces the file with the given contents, such that readers only ever see
+// the old or the new file in full. The data is written to a temporary file in
+// the same directory, flushed to disk, and then renamed over the original.
+// Throws std::runtime_error on failure, leaving the original untouched.
+void WriteFileAtomically(const std::string& filename,
+                         std::string_view contents);
+
+// Writes files atomically on a background thread, in the order they were
+// submitted.
+class BackgroundFileWriter {
+ public:
+  // Called on the writer thread once a file has been written, with the error
+  // message if it failed.
+  using Callback = std::function<void(std::optional<std::string> error)>;
+
+  BackgroundFileWriter();
+
+  BackgroundFileWriter(const BackgroundFileWriter&) = delete;
+  BackgroundFileWriter& operator=(const BackgroundFileWriter&) = delete;
+
+  // Waits for any outstanding writes to finish.
+  ~BackgroundFileWriter();
+
+  void Submit(std::string filename, std::shared_ptr<const std::string> contents,
+              Callback callback);
+
+  // Blocks until every submitted write has finished and its callback has
+  // returned.
+  void Drain();
+
+ private:
+  struct Job {
+    std::string filename;
+    std::shared_ptr<const std::string> contents;
+    Callback callback;
+  };
+
+  void Run();
+
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable job_cv_;
+  std::condition_variable idle_cv_;
+  std::deque<Job> jobs_;
+  bool busy_ = false;
+  bool stop_ = false;
+};
+
+#endif /* end of include guard: FILE_WRITER_H_5C81A2F3 */
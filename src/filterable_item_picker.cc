@@ -1,5 +1,13 @@
 #include "filterable_item_picker.h"
 
+#include <vector>
+
+#include "allocation_counter.h"
+#include "item_filter.h"
+#include "session_script.h"
+#include "timing_stats.h"
+#include "trace.h"
+
 wxDEFINE_EVENT(EVT_PICK_ITEM, wxCommandEvent);
 
 FilterableItemPicker::FilterableItemPicker(wxWindow* parent, wxWindowID id,
@@ -45,27 +53,36 @@ std::optional<std::string> FilterableItemPicker::GetSelected() const {
   return source_list_->GetItemText(selection, 0).ToStdString();
 }
 
+void FilterableItemPicker::SetFilter(const wxString& text) {
+  source_filter_->SetValue(text);
+}
+
 void FilterableItemPicker::UpdateSourceList() {
+  TRACE_SPAN("FilterableItemPicker::UpdateSourceList");
+  ScopedTiming timing(TimedOperation::kFilterQuery);
+  ALLOCATION_PROBE("Filter items");
+
   source_list_->ClearAll();
   source_list_->AppendColumn("Value");
 
-  int i = 0;
-  for (const std::string& list_item : items_->GetList()) {
-    if (!source_filter_->GetValue().IsEmpty()) {
-      wxString wx_list = wxString(list_item).Lower();
-      if (wx_list.Find(source_filter_->GetValue().Lower()) == wxNOT_FOUND) {
-        continue;
-      }
-    }
-
-    source_list_->InsertItem(i, list_item);
-    i++;
+  std::vector<size_t> matches = FilterItems(
+      items_->GetList(), source_filter_->GetValue().ToStdString());
+
+  for (size_t i = 0; i < matches.size(); i++) {
+    source_list_->InsertItem(i, items_->GetValue(matches[i]));
   }
 
   source_list_->SetColumnWidth(0, wxLIST_AUTOSIZE);
 }
 
 void FilterableItemPicker::OnFilterEdited(wxCommandEvent&) {
+  if (IsRecordingSession()) {
+    SessionStep step;
+    step.type = SessionStepType::kFilter;
+    step.text = source_filter_->GetValue().ToStdString();
+    RecordSessionStep(step);
+  }
+
   UpdateSourceList();
 }
 
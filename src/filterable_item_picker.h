@@ -22,6 +22,9 @@ class FilterableItemPicker : public wxPanel {
 
   std::optional<std::string> GetSelected() const;
 
+  // Replaces the filter text, as if it had been typed.
+  void SetFilter(const wxString& text);
+
  private:
   void UpdateSourceList();
 
@@ -1,17 +1,184 @@
 #include "game_definition.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <nlohmann/json.hpp>
 #include <set>
+#include <stdexcept>
 
-#include "util.h"
+#include "allocation_counter.h"
+#include "core_util.h"
+#include "timing_stats.h"
+#include "trace.h"
+
+namespace {
+
+// boost::hash_combine, widened to 64 bits.
+uint64_t CombineHash(uint64_t seed, uint64_t value) {
+  return seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 12) + (seed >> 4));
+}
+
+}  // namespace
+
+uint64_t HashOptionValue(const OptionValue& option_value) {
+  uint64_t hash = CombineHash(0, option_value.random);
+  hash = CombineHash(hash, std::hash<std::string>{}(option_value.string_value));
+  hash = CombineHash(hash, option_value.int_value);
+
+  // The standard library hashes bitsets a word at a time.
+  hash = CombineHash(hash, option_value.set_values->size());
+  hash = CombineHash(hash,
+                     std::hash<std::vector<bool>>{}(*option_value.set_values));
+
+  for (const auto& [id, amount] : *option_value.dict_values) {
+    hash = CombineHash(hash, id);
+    hash = CombineHash(hash, amount);
+  }
+
+  hash = CombineHash(hash, option_value.weight);
+  for (const OptionValue& weight_value : *option_value.weighting) {
+    hash = CombineHash(hash, HashOptionValue(weight_value));
+  }
+
+  hash = CombineHash(hash, option_value.range_random_type);
+  if (option_value.range_subset) {
+    hash = CombineHash(hash, std::get<0>(*option_value.range_subset));
+    hash = CombineHash(hash, std::get<1>(*option_value.range_subset));
+  }
+
+  for (const Diagnostic& diagnostic : option_value.errors) {
+    hash = CombineHash(hash, static_cast<uint64_t>(diagnostic.code));
+  }
+
+  return hash;
+}
+
+CompactOptionValue ToCompactOptionValue(OptionValue option_value) {
+  using Compact = CompactOptionValue;
+
+  Compact result;
+  result.weight = option_value.weight;
+  if (!option_value.errors.empty()) {
+    result.errors.Mutable() = std::move(option_value.errors);
+  }
+
+  // Each kind is only used when every field outside of it is unset, so that
+  // there is one way to hold any value.
+  bool has_scalar = option_value.random || !option_value.string_value.empty() ||
+                    option_value.int_value != 0 ||
+                    option_value.range_random_type !=
+                        kUNKNOWN_RANDOM_VALUE_TYPE ||
+                    option_value.range_subset.has_value();
+  bool has_set = !option_value.set_values->empty();
+  bool has_dict = !option_value.dict_values->empty();
+  bool has_weighting = !option_value.weighting->empty();
+
+  if (has_weighting) {
+    if (option_value.random && option_value.string_value.empty() &&
+        option_value.int_value == 0 &&
+        option_value.range_random_type == kUNKNOWN_RANDOM_VALUE_TYPE &&
+        !option_value.range_subset && !has_set && !has_dict) {
+      std::vector<Compact> values;
+      values.reserve(option_value.weighting->size());
+      for (const OptionValue& weight_value : *option_value.weighting) {
+        values.push_back(ToCompactOptionValue(weight_value));
+      }
+
+      result.value = Compact::Weighted{CopyOnWrite(std::move(values))};
+      return result;
+    }
+  } else if (has_set) {
+    if (!has_scalar && !has_dict) {
+      result.value = Compact::Set{std::move(option_value.set_values)};
+      return result;
+    }
+  } else if (has_dict) {
+    if (!has_scalar) {
+      result.value = Compact::Dict{std::move(option_value.dict_values)};
+      return result;
+    }
+  } else if (option_value.random) {
+    if (option_value.string_value.empty() && option_value.int_value == 0) {
+      result.value = Compact::Random{option_value.range_random_type,
+                                     option_value.range_subset};
+      return result;
+    }
+  } else if (option_value.range_random_type == kUNKNOWN_RANDOM_VALUE_TYPE &&
+             !option_value.range_subset) {
+    if (option_value.string_value.empty()) {
+      result.value = Compact::Number{option_value.int_value};
+      return result;
+    } else if (option_value.int_value == 0) {
+      result.value = Compact::Choice{std::move(option_value.string_value)};
+      return result;
+    }
+  }
+
+  option_value.weight = 50;
+  result.value = Compact::Other{CopyOnWrite(std::move(option_value))};
+
+  return result;
+}
+
+OptionValue ToOptionValue(const CompactOptionValue& compact_value) {
+  using Compact = CompactOptionValue;
+
+  OptionValue result;
+  if (const auto* number = std::get_if<Compact::Number>(&compact_value.value)) {
+    result.int_value = number->value;
+  } else if (const auto* choice =
+                 std::get_if<Compact::Choice>(&compact_value.value)) {
+    result.string_value = choice->name;
+  } else if (const auto* random =
+                 std::get_if<Compact::Random>(&compact_value.value)) {
+    result.random = true;
+    result.range_random_type = random->type;
+    result.range_subset = random->range;
+  } else if (const auto* set =
+                 std::get_if<Compact::Set>(&compact_value.value)) {
+    result.set_values = set->values;
+  } else if (const auto* dict =
+                 std::get_if<Compact::Dict>(&compact_value.value)) {
+    result.dict_values = dict->values;
+  } else if (const auto* weighted =
+                 std::get_if<Compact::Weighted>(&compact_value.value)) {
+    result.random = true;
+
+    std::vector<OptionValue>& weighting = result.weighting.Mutable();
+    weighting.reserve(weighted->values->size());
+    for (const Compact& weight_value : *weighted->values) {
+      weighting.push_back(ToOptionValue(weight_value));
+    }
+  } else if (const auto* other =
+                 std::get_if<Compact::Other>(&compact_value.value)) {
+    result = *other->value;
+  }
+
+  result.weight = compact_value.weight;
+  result.errors = *compact_value.errors;
+
+  return result;
+}
+
+GameDefinitions::GameDefinitions()
+    : GameDefinitions(GetAbsolutePath("dumped-options.json")) {}
+
+GameDefinitions::GameDefinitions(const std::string& filename) {
+  TRACE_SPAN("GameDefinitions", filename);
+  ScopedTiming timing(TimedOperation::kCatalogLoad);
+
+  std::ifstream datafile(filename);
+  if (!datafile) {
+    throw std::runtime_error("Could not open \"" + filename + "\".");
+  }
 
-GameDefinitions::GameDefinitions() {
-  std::ifstream datafile(GetAbsolutePath("dumped-options.json"));
   nlohmann::ordered_json all_games = nlohmann::ordered_json::parse(datafile);
 
   for (const auto& [game_name, game_data] : all_games.items()) {
+    TRACE_SPAN("GameDefinitions::Game", game_name);
+    ALLOCATION_PROBE("Load game");
+
     std::vector<OptionDefinition> options;
 
     std::set<std::string> sorted_game_items;
@@ -93,37 +260,42 @@ GameDefinitions::GameDefinitions() {
 
         for (const auto& choice : option_data["options"]) {
           option.custom_set.Append(choice);
-          option.default_value.set_values.push_back(false);
         }
 
+        std::vector<bool>& set_values =
+            option.default_value.set_values.Mutable();
+        set_values.resize(option.custom_set.size());
+
         for (const auto& default_value : option_data["defaultValue"]) {
-          option.default_value
-              .set_values[option.custom_set.GetId(default_value)] = true;
+          set_values[option.custom_set.GetId(default_value)] = true;
         }
       } else if (option_data["type"] == "items-set") {
         option.type = kSetOption;
         option.set_type = kItemSet;
-        option.default_value.set_values.resize(game_items.size());
+        std::vector<bool>& set_values =
+            option.default_value.set_values.Mutable();
+        set_values.resize(game_items.size());
 
         for (const auto& default_value : option_data["defaultValue"]) {
-          option.default_value.set_values[game_items.GetId(default_value)] =
-              true;
+          set_values[game_items.GetId(default_value)] = true;
         }
       } else if (option_data["type"] == "items-dict") {
         option.type = kDictOption;
         option.set_type = kItemSet;
 
         for (const auto& default_value : option_data["defaultValue"]) {
-          option.default_value.dict_values[game_items.GetId(default_value)] = 1;
+          option.default_value.dict_values
+              .Mutable()[game_items.GetId(default_value)] = 1;
         }
       } else if (option_data["type"] == "locations-set") {
         option.type = kSetOption;
         option.set_type = kLocationSet;
-        option.default_value.set_values.resize(game_locations.size());
+        std::vector<bool>& set_values =
+            option.default_value.set_values.Mutable();
+        set_values.resize(game_locations.size());
 
         for (const auto& default_value : option_data["defaultValue"]) {
-          option.default_value.set_values[game_locations.GetId(default_value)] =
-              true;
+          set_values[game_locations.GetId(default_value)] = true;
         }
       } else if (option_data["type"] == "range" ||
                  option_data["type"] == "named_range") {
@@ -221,19 +393,24 @@ GameDefinitions::GameDefinitions() {
       options.push_back(std::move(option));
     }
 
-    std::map<std::string, const OptionDefinition*> options_by_name;
-    for (const OptionDefinition& od : options) {
-      options_by_name[od.name] = &od;
+    std::map<std::string, size_t> option_indices;
+    for (size_t i = 0; i < options.size(); i++) {
+      option_indices[options[i].name] = i;
     }
 
-    std::map<std::string, std::map<std::string, OptionValue>> presets;
+    std::map<std::string, PresetOptions> presets;
     for (const auto& [preset_name, preset_options] :
          game_data["presets"].items()) {
-      std::map<std::string, OptionValue> values;
+      PresetOptions values;
 
       for (const auto& [option_name, option_value] : preset_options.items()) {
+        auto option_index = option_indices.find(option_name);
+        if (option_index == option_indices.end()) {
+          continue;
+        }
+
         const OptionDefinition& option_definition =
-            *options_by_name[option_name];
+            options[option_index->second];
 
         OptionValue ov;
         if (option_value.is_string() && option_value == "random") {
@@ -262,13 +439,19 @@ GameDefinitions::GameDefinitions() {
           }
         }
 
-        values[option_name] = std::move(ov);
+        values.emplace_back(option_index->second,
+                            ToCompactOptionValue(std::move(ov)));
       }
 
+      std::sort(values.begin(), values.end(),
+                [](const auto& lhs, const auto& rhs) {
+                  return std::get<0>(lhs) < std::get<0>(rhs);
+                });
+
       presets[preset_name] = std::move(values);
     }
 
-    std::cout << "Read " << options.size() << " options for " << game_name
+    std::clog << "Read " << options.size() << " options for " << game_name
               << std::endl;
     games_.emplace(std::piecewise_construct, std::forward_as_tuple(game_name),
                    std::forward_as_tuple(
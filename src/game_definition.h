@@ -1,13 +1,18 @@
 #ifndef GAME_DEFINITION_H_10B5D32A
 #define GAME_DEFINITION_H_10B5D32A
 
+#include <cstdint>
 #include <map>
 #include <optional>
 #include <set>
 #include <string>
 #include <tuple>
+#include <unordered_map>
+#include <variant>
 #include <vector>
 
+#include "copy_on_write.h"
+#include "diagnostic.h"
 #include "double_map.h"
 #include "ordered_bijection.h"
 
@@ -34,22 +39,97 @@ enum RandomValueType {
   kHighRandom,
 };
 
+// The larger parts of a value are shared between copies until they're
+// changed, so that handing out defaults and preset values is cheap. Write to
+// them through Mutable().
 struct OptionValue {
   bool random = false;
   std::string string_value;
   int int_value = 0;
-  std::vector<bool> set_values;
-  std::map<int, int> dict_values;
+  CopyOnWrite<std::vector<bool>> set_values;
+  CopyOnWrite<std::map<int, int>> dict_values;
 
   int weight = 50;
-  std::vector<OptionValue> weighting;
+  CopyOnWrite<std::vector<OptionValue>> weighting;
 
   RandomValueType range_random_type = kUNKNOWN_RANDOM_VALUE_TYPE;
   std::optional<std::tuple<int, int>> range_subset;  // low, high
 
-  std::optional<std::string> error;
+  std::vector<Diagnostic> errors;
+
+  bool operator==(const OptionValue&) const = default;
 };
 
+// A hash of everything that OptionValue's equality compares, so that values
+// that are equal hash the same.
+uint64_t HashOptionValue(const OptionValue& option_value);
+
+// The form worlds and presets keep their values in. OptionValue has room for
+// every kind of value at once; this only holds the fields of the kind it is,
+// and keeps diagnostics out of line, as almost every value has none.
+struct CompactOptionValue {
+  // A range value, or a choice by ID.
+  struct Number {
+    int value;  // zero in a default-constructed value
+
+    bool operator==(const Number&) const = default;
+  };
+
+  // A choice, by name.
+  struct Choice {
+    std::string name;
+
+    bool operator==(const Choice&) const = default;
+  };
+
+  // A random specifier, for a choice or range.
+  struct Random {
+    RandomValueType type = kUNKNOWN_RANDOM_VALUE_TYPE;
+    std::optional<std::tuple<int, int>> range;  // low, high
+
+    bool operator==(const Random&) const = default;
+  };
+
+  struct Set {
+    CopyOnWrite<std::vector<bool>> values;
+
+    bool operator==(const Set&) const = default;
+  };
+
+  struct Dict {
+    CopyOnWrite<std::map<int, int>> values;
+
+    bool operator==(const Dict&) const = default;
+  };
+
+  // Random, picking from the entries by their weights.
+  struct Weighted {
+    CopyOnWrite<std::vector<CompactOptionValue>> values;
+
+    bool operator==(const Weighted&) const = default;
+  };
+
+  // Any combination of fields that none of the above can hold, kept as it
+  // is so that converting back gives the same value. Its weight and errors
+  // are left unset.
+  struct Other {
+    CopyOnWrite<OptionValue> value;
+
+    bool operator==(const Other&) const = default;
+  };
+
+  std::variant<Number, Choice, Random, Set, Dict, Weighted, Other> value;
+  int weight = 50;
+  CopyOnWrite<std::vector<Diagnostic>> errors;
+
+  bool operator==(const CompactOptionValue&) const = default;
+};
+
+// Values that are equal convert to values that are equal, and converting
+// back gives the value that was converted.
+CompactOptionValue ToCompactOptionValue(OptionValue option_value);
+OptionValue ToOptionValue(const CompactOptionValue& compact_value);
+
 struct OptionDefinition {
   OptionType type = kUNKNOWN_OPTION_TYPE;
   bool common = false;
@@ -74,18 +154,23 @@ struct OptionDefinition {
   OptionValue default_value;
 };
 
+// A preset's values, keyed by the index of each option in its game and sorted
+// by it. These are resolved when the games are loaded, so that applying a
+// preset doesn't need to look anything up by name.
+using PresetOptions = std::vector<std::tuple<size_t, CompactOptionValue>>;
+
 class Game {
  public:
   Game(std::string name, std::vector<OptionDefinition> options,
        DoubleMap<std::string> items, DoubleMap<std::string> locations,
-       std::map<std::string, std::map<std::string, OptionValue>> presets)
+       std::map<std::string, PresetOptions> presets)
       : name_(std::move(name)),
         options_(std::move(options)),
         items_(std::move(items)),
         locations_(std::move(locations)),
         presets_(std::move(presets)) {
-    for (const OptionDefinition& option : options_) {
-      options_by_name_[option.name] = option;
+    for (size_t i = 0; i < options_.size(); i++) {
+      option_indices_[options_[i].name] = i;
     }
   }
 
@@ -93,32 +178,44 @@ class Game {
 
   const std::vector<OptionDefinition>& GetOptions() const { return options_; }
 
+  bool HasOption(const std::string& option_name) const {
+    return option_indices_.count(option_name);
+  }
+
   const OptionDefinition& GetOption(const std::string& option_name) const {
-    return options_by_name_.at(option_name);
+    return options_.at(option_indices_.at(option_name));
+  }
+
+  // Returns nullptr if the game has no such option.
+  const OptionDefinition* FindOption(const std::string& option_name) const {
+    auto it = option_indices_.find(option_name);
+    return it == option_indices_.end() ? nullptr : &options_[it->second];
   }
 
   const DoubleMap<std::string>& GetItems() const { return items_; }
 
   const DoubleMap<std::string>& GetLocations() const { return locations_; }
 
-  const std::map<std::string, std::map<std::string, OptionValue>>& GetPresets()
-      const {
+  const std::map<std::string, PresetOptions>& GetPresets() const {
     return presets_;
   }
 
  private:
   std::string name_;
   std::vector<OptionDefinition> options_;
-  std::map<std::string, OptionDefinition> options_by_name_;
+  std::unordered_map<std::string, size_t> option_indices_;
   DoubleMap<std::string> items_;
   DoubleMap<std::string> locations_;
-  std::map<std::string, std::map<std::string, OptionValue>> presets_;
+  std::map<std::string, PresetOptions> presets_;
 };
 
 class GameDefinitions {
  public:
+  // Reads dumped-options.json from next to the executable.
   GameDefinitions();
 
+  explicit GameDefinitions(const std::string& filename);
+
   bool HasGame(const std::string& game) const { return games_.count(game); }
 
   const Game& GetGame(const std::string& game) const { return games_.at(game); }
@@ -1,7 +1,9 @@
 #include "item_dict_dialog.h"
 
+#include "allocation_counter.h"
 #include "double_map.h"
 #include "filterable_item_picker.h"
+#include "trace.h"
 #include "util.h"
 
 ItemDictDialog::ItemDictDialog(const Game* game, const std::string& option_name,
@@ -10,6 +12,9 @@ ItemDictDialog::ItemDictDialog(const Game* game, const std::string& option_name,
                wxDefaultSize, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
       game_(game),
       option_definition_(&game->GetOption(option_name)) {
+  TRACE_SPAN("ItemDictDialog", option_name);
+  ALLOCATION_PROBE("Open dialog");
+
   // Initialize the form.
   wxBoxSizer* top_sizer = new wxBoxSizer(wxVERTICAL);
 
@@ -52,7 +57,15 @@ ItemDictDialog::ItemDictDialog(const Game* game, const std::string& option_name,
   value_sizer_->AddGrowableCol(0);
   value_panel_->SetSizer(value_sizer_);
 
-  lists_sizer->Add(value_panel_,
+  wxButton* import_btn = new wxButton(lists_panel, wxID_ANY, "Import...");
+  import_btn->Bind(wxEVT_BUTTON, &ItemDictDialog::OnImportClicked, this);
+
+  wxBoxSizer* right_sizer = new wxBoxSizer(wxVERTICAL);
+  right_sizer->Add(value_panel_, wxSizerFlags().Proportion(1).Expand());
+  right_sizer->AddSpacer(10);
+  right_sizer->Add(import_btn, wxSizerFlags().Center());
+
+  lists_sizer->Add(right_sizer,
                    wxSizerFlags().DoubleBorder().Proportion(1).Expand());
 
   lists_panel->SetSizerAndFit(lists_sizer);
@@ -77,7 +90,7 @@ ItemDictDialog::ItemDictDialog(const Game* game, const std::string& option_name,
   // Load in existing values.
   const DoubleMap<std::string>& option_set =
       GetOptionSetElements(*game_, option_name);
-  for (const auto& [id, amount] : option_value.dict_values) {
+  for (const auto& [id, amount] : *option_value.dict_values) {
     AddRow(option_set.GetValue(id), value_panel_, value_sizer_, amount);
   }
 }
@@ -87,9 +100,10 @@ OptionValue ItemDictDialog::GetOptionValue() const {
       GetOptionSetElements(*game_, option_definition_->name);
 
   OptionValue option_value;
+  std::map<int, int>& dict_values = option_value.dict_values.Mutable();
 
   for (const auto& [value, row] : values_) {
-    option_value.dict_values[option_set.GetId(value)] = row.amount;
+    dict_values[option_set.GetId(value)] = row.amount;
   }
 
   return option_value;
@@ -147,4 +161,45 @@ void ItemDictDialog::OnDeleteClicked(wxCommandEvent& event) {
   Fit();
 
   values_.erase(rrd_value);
-}
\ No newline at end of file
+}
+
+void ItemDictDialog::OnImportClicked(wxCommandEvent& event) {
+  wxTextEntryDialog import_dialog(
+      this, "Paste a list of values, one per line, as \"name: count\":",
+      "Import Values", "", wxTextEntryDialogStyle | wxTE_MULTILINE);
+  if (import_dialog.ShowModal() != wxID_OK) {
+    return;
+  }
+
+  const DoubleMap<std::string>& option_set =
+      GetOptionSetElements(*game_, option_definition_->name);
+  BulkImportResult result =
+      ParseBulkImport(option_set, import_dialog.GetValue().ToStdString());
+
+  value_panel_->Freeze();
+
+  for (const auto& [id, amount] : result.entries) {
+    if (amount <= 0) {
+      continue;
+    }
+
+    const std::string& value = option_set.GetValue(id);
+
+    auto it = values_.find(value);
+    if (it != values_.end()) {
+      it->second.amount = amount;
+      it->second.spin_ctrl->SetValue(amount);
+    } else {
+      AddRow(value, value_panel_, value_sizer_, amount);
+    }
+  }
+
+  value_panel_->Layout();
+  value_panel_->FitInside();
+  value_panel_->Thaw();
+
+  if (!result.unknown.empty()) {
+    wxMessageBox(FormatBulkImportReport(result), "Import Values",
+                 wxOK | wxICON_WARNING, this);
+  }
+}
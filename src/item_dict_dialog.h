@@ -26,6 +26,7 @@ class ItemDictDialog : public wxDialog {
  private:
   void OnItemPicked(wxCommandEvent& event);
   void OnDeleteClicked(wxCommandEvent& event);
+  void OnImportClicked(wxCommandEvent& event);
 
   void AddRow(const std::string& value, wxWindow* parent, wxSizer* sizer,
               int default_value = 1);
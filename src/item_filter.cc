@@ -0,0 +1,33 @@
+#include "item_filter.h"
+
+#include <algorithm>
+
+#include "core_util.h"
+
+std::vector<size_t> FilterItems(const std::vector<std::string>& items,
+                                std::string_view filter) {
+  std::vector<size_t> result;
+
+  if (filter.empty()) {
+    result.resize(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+      result[i] = i;
+    }
+
+    return result;
+  }
+
+  std::string needle = ToLower(filter);
+
+  // Compare in place, rather than lowering a copy of every item.
+  for (size_t i = 0; i < items.size(); i++) {
+    const std::string& item = items[i];
+    if (std::search(item.begin(), item.end(), needle.begin(), needle.end(),
+                    [](char lhs, char rhs) { return ToLower(lhs) == rhs; }) !=
+        item.end()) {
+      result.push_back(i);
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,14 @@
+#ifndef ITEM_FILTER_H_2D94B6E1
+#define ITEM_FILTER_H_2D94B6E1
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Returns the indices of the items that contain the filter text, ignoring
+// (ASCII) case, in their original order. An empty filter matches everything.
+std::vector<size_t> FilterItems(const std::vector<std::string>& items,
+                                std::string_view filter);
+
+#endif /* end of include guard: ITEM_FILTER_H_2D94B6E1 */
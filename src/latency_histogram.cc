@@ -0,0 +1,74 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+// The first bucket holds everything up to this; each one after it doubles.
+constexpr double kFirstBucketMilliseconds = 0.25;
+
+}  // namespace
+
+void LatencyHistogram::Add(double milliseconds) {
+  if (!samples_.empty() && milliseconds < samples_.back()) {
+    sorted_ = false;
+  }
+
+  samples_.push_back(milliseconds);
+}
+
+double LatencyHistogram::GetPercentile(double percentile) const {
+  if (samples_.empty()) {
+    return 0;
+  }
+
+  if (!sorted_) {
+    std::sort(samples_.begin(), samples_.end());
+    sorted_ = true;
+  }
+
+  size_t rank =
+      static_cast<size_t>(std::ceil(percentile / 100 * samples_.size()));
+
+  return samples_[std::max<size_t>(rank, 1) - 1];
+}
+
+nlohmann::ordered_json LatencyHistogram::ToJson() const {
+  nlohmann::ordered_json result;
+  result["count"] = samples_.size();
+
+  if (samples_.empty()) {
+    return result;
+  }
+
+  result["mean_milliseconds"] =
+      std::accumulate(samples_.begin(), samples_.end(), 0.0) / samples_.size();
+  result["p50_milliseconds"] = GetPercentile(50);
+  result["p90_milliseconds"] = GetPercentile(90);
+  result["p99_milliseconds"] = GetPercentile(99);
+  result["max_milliseconds"] = GetPercentile(100);
+
+  // The samples are sorted by now, so each bucket is a contiguous run.
+  nlohmann::ordered_json buckets = nlohmann::ordered_json::array();
+  double limit = kFirstBucketMilliseconds;
+  size_t count = 0;
+  for (double sample : samples_) {
+    while (sample > limit) {
+      if (count > 0) {
+        buckets.push_back({{"up_to_milliseconds", limit}, {"count", count}});
+        count = 0;
+      }
+
+      limit *= 2;
+    }
+
+    count++;
+  }
+  buckets.push_back({{"up_to_milliseconds", limit}, {"count", count}});
+
+  result["histogram"] = std::move(buckets);
+
+  return result;
+}
@@ -0,0 +1,29 @@
+#ifndef LATENCY_HISTOGRAM_H_71D2E8A4
+#define LATENCY_HISTOGRAM_H_71D2E8A4
+
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+// Collects wall times and summarises them as percentiles and a histogram
+// with power-of-two millisecond buckets.
+class LatencyHistogram {
+ public:
+  void Add(double milliseconds);
+
+  size_t GetCount() const { return samples_.size(); }
+
+  // The nearest-rank percentile, or 0 if there are no samples.
+  double GetPercentile(double percentile) const;
+
+  // The count, mean, p50, p90, p99 and max, and the non-empty buckets, each
+  // given by the largest time it holds.
+  nlohmann::ordered_json ToJson() const;
+
+ private:
+  // Sorted when a percentile is first asked for.
+  mutable std::vector<double> samples_;
+  mutable bool sorted_ = true;
+};
+
+#endif /* end of include guard: LATENCY_HISTOGRAM_H_71D2E8A4 */
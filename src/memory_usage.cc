@@ -0,0 +1,197 @@
+#include "memory_usage.h"
+
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// The colour and three links of a std::map node.
+constexpr size_t kMapNodeOverhead = 4 * sizeof(void*);
+
+// The link and cached hash of a std::unordered_map node, plus its bucket.
+constexpr size_t kHashNodeOverhead = 2 * sizeof(void*) + sizeof(size_t);
+
+// yaml-cpp allocates a node, a reference and the node's data, each behind a
+// shared pointer, for every node in a document.
+constexpr size_t kYamlNodeSize = 320;
+
+template <typename K, typename V>
+size_t GetMapSize(size_t count) {
+  return count * (kMapNodeOverhead + sizeof(std::pair<const K, V>));
+}
+
+template <typename T>
+size_t GetVectorSize(const std::vector<T>& values) {
+  return values.capacity() * sizeof(T);
+}
+
+// The shared pointer's control block and the object are allocated together.
+// A payload shared between values is split evenly between them.
+template <typename T>
+size_t GetSharedSize(const CopyOnWrite<T>& value, size_t heap_size) {
+  size_t share_count = value.GetShareCount();
+  if (share_count == 0) {
+    return 0;
+  }
+
+  return (2 * sizeof(long) + sizeof(void*) + sizeof(T) + heap_size) /
+         share_count;
+}
+
+size_t GetDoubleMapSize(const DoubleMap<std::string>& map, size_t& strings) {
+  for (const std::string& value : map.GetList()) {
+    // Once in the list and once as a key of the index.
+    strings += 2 * GetMemoryUsage(value);
+  }
+
+  return GetVectorSize(map.GetList()) +
+         map.size() * (kHashNodeOverhead +
+                       sizeof(std::pair<const std::string, size_t>));
+}
+
+size_t GetBijectionSize(const OrderedBijection<int, std::string>& bijection,
+                        size_t& strings) {
+  size_t count = bijection.GetItems().size();
+  for (const auto& [key, value] : bijection.GetItems()) {
+    // In the ordering, and in three of the four maps.
+    strings += 4 * GetMemoryUsage(value);
+  }
+
+  return GetVectorSize(bijection.GetItems()) +
+         GetMapSize<int, std::string>(count) +
+         GetMapSize<std::string, int>(count) + GetMapSize<int, size_t>(count) +
+         GetMapSize<std::string, size_t>(count);
+}
+
+size_t GetOptionSize(const OptionDefinition& option, size_t& strings) {
+  strings += GetMemoryUsage(option.name) +
+             GetMemoryUsage(option.display_name) +
+             GetMemoryUsage(option.description);
+
+  size_t size = GetBijectionSize(option.value_names, strings) +
+                GetDoubleMapSize(option.custom_set, strings) +
+                GetBijectionSize(option.choices, strings) +
+                GetVectorSize(option.choice_names) +
+                GetMapSize<std::string, std::string>(option.aliases.size());
+
+  for (const std::string& choice_name : option.choice_names) {
+    strings += GetMemoryUsage(choice_name);
+  }
+
+  for (const auto& [alias, name] : option.aliases) {
+    strings += GetMemoryUsage(alias) + GetMemoryUsage(name);
+  }
+
+  return size + GetMemoryUsage(option.default_value);
+}
+
+}  // namespace
+
+GameMemoryUsage GetMemoryUsage(const Game& game) {
+  GameMemoryUsage usage;
+
+  usage.options = GetVectorSize(game.GetOptions());
+  for (const OptionDefinition& option : game.GetOptions()) {
+    usage.options += GetOptionSize(option, usage.strings);
+  }
+
+  // The index of the options by name.
+  usage.options += game.GetOptions().size() *
+                   (kHashNodeOverhead +
+                    sizeof(std::pair<const std::string, size_t>));
+
+  usage.items = GetDoubleMapSize(game.GetItems(), usage.strings);
+  usage.locations = GetDoubleMapSize(game.GetLocations(), usage.strings);
+
+  usage.presets =
+      GetMapSize<std::string, PresetOptions>(game.GetPresets().size());
+  for (const auto& [preset_name, preset_options] : game.GetPresets()) {
+    usage.strings += GetMemoryUsage(preset_name);
+    usage.presets += GetVectorSize(preset_options);
+
+    for (const auto& [option_index, option_value] : preset_options) {
+      usage.presets += GetMemoryUsage(option_value);
+    }
+  }
+
+  return usage;
+}
+
+size_t GetMemoryUsage(const std::string& value) {
+  // Short strings are stored inline.
+  static const size_t inline_capacity = std::string().capacity();
+
+  return value.capacity() > inline_capacity ? value.capacity() + 1 : 0;
+}
+
+size_t GetMemoryUsage(const OptionValue& value) {
+  size_t size = GetMemoryUsage(value.string_value) +
+                GetVectorSize(value.errors) +
+                GetSharedSize(value.set_values,
+                              (value.set_values->capacity() + 7) / 8) +
+                GetSharedSize(value.dict_values,
+                              GetMapSize<int, int>(value.dict_values->size()));
+
+  size_t weighting_size = GetVectorSize(*value.weighting);
+  for (const OptionValue& weight_value : *value.weighting) {
+    weighting_size += GetMemoryUsage(weight_value);
+  }
+  size += GetSharedSize(value.weighting, weighting_size);
+
+  for (const Diagnostic& diagnostic : value.errors) {
+    size += GetMemoryUsage(diagnostic.value);
+  }
+
+  return size;
+}
+
+size_t GetMemoryUsage(const CompactOptionValue& value) {
+  using Compact = CompactOptionValue;
+
+  size_t size = 0;
+  if (const auto* choice = std::get_if<Compact::Choice>(&value.value)) {
+    size += GetMemoryUsage(choice->name);
+  } else if (const auto* set = std::get_if<Compact::Set>(&value.value)) {
+    size += GetSharedSize(set->values, (set->values->capacity() + 7) / 8);
+  } else if (const auto* dict = std::get_if<Compact::Dict>(&value.value)) {
+    size += GetSharedSize(dict->values,
+                          GetMapSize<int, int>(dict->values->size()));
+  } else if (const auto* weighted =
+                 std::get_if<Compact::Weighted>(&value.value)) {
+    size_t weighting_size = GetVectorSize(*weighted->values);
+    for (const Compact& weight_value : *weighted->values) {
+      weighting_size += GetMemoryUsage(weight_value);
+    }
+    size += GetSharedSize(weighted->values, weighting_size);
+  } else if (const auto* other = std::get_if<Compact::Other>(&value.value)) {
+    size += GetSharedSize(other->value, GetMemoryUsage(*other->value));
+  }
+
+  size_t errors_size = GetVectorSize(*value.errors);
+  for (const Diagnostic& diagnostic : *value.errors) {
+    errors_size += GetMemoryUsage(diagnostic.value);
+  }
+  size += GetSharedSize(value.errors, errors_size);
+
+  return size;
+}
+
+size_t GetMemoryUsage(const YAML::Node& node) {
+  size_t size = kYamlNodeSize + GetMemoryUsage(node.Tag());
+
+  if (node.IsScalar()) {
+    size += GetMemoryUsage(node.Scalar());
+  } else if (node.IsSequence()) {
+    for (const YAML::Node& element : node) {
+      size += GetMemoryUsage(element);
+    }
+  } else if (node.IsMap()) {
+    for (const auto& element : node) {
+      size += GetMemoryUsage(element.first) + GetMemoryUsage(element.second);
+    }
+  }
+
+  return size;
+}
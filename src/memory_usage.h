@@ -0,0 +1,35 @@
+#ifndef MEMORY_USAGE_H_90C4B27E
+#define MEMORY_USAGE_H_90C4B27E
+
+#include <yaml-cpp/yaml.h>
+
+#include <cstddef>
+#include <string>
+
+#include "game_definition.h"
+
+// Estimates of how much memory the model uses, for the diagnostics panel.
+// They are worked out from container sizes and typical node layouts rather
+// than measured, so they are approximate, but comparable with each other.
+
+struct GameMemoryUsage {
+  size_t options = 0;
+  size_t items = 0;
+  size_t locations = 0;
+  size_t presets = 0;
+  size_t strings = 0;  // the text of the strings in all of the above
+
+  size_t GetTotal() const {
+    return options + items + locations + presets + strings;
+  }
+};
+
+GameMemoryUsage GetMemoryUsage(const Game& game);
+
+// The heap memory owned by each of these, not counting the object itself.
+size_t GetMemoryUsage(const std::string& value);
+size_t GetMemoryUsage(const OptionValue& value);
+size_t GetMemoryUsage(const CompactOptionValue& value);
+size_t GetMemoryUsage(const YAML::Node& node);
+
+#endif /* end of include guard: MEMORY_USAGE_H_90C4B27E */
@@ -35,14 +35,7 @@ int NumericPicker::GetValue() const { return value_; }
 
 void NumericPicker::SetValue(int v) {
   if (value_ != v) {
-    value_ = v;
-
-    if (slider_->GetValue() != value_) {
-      slider_->SetValue(value_);
-    }
-    if (spin_ctrl_->GetValue() != value_) {
-      spin_ctrl_->SetValue(std::to_string(value_));
-    }
+    ChangeValue(v);
 
     wxCommandEvent picked_event(EVT_PICK_NUMBER, GetId());
     picked_event.SetInt(value_);
@@ -51,6 +44,17 @@ void NumericPicker::SetValue(int v) {
   }
 }
 
+void NumericPicker::ChangeValue(int v) {
+  value_ = v;
+
+  if (slider_->GetValue() != value_) {
+    slider_->SetValue(value_);
+  }
+  if (spin_ctrl_->GetValue() != value_) {
+    spin_ctrl_->SetValue(std::to_string(value_));
+  }
+}
+
 void NumericPicker::OnSliderChanged(wxCommandEvent& event) {
   SetValue(slider_->GetValue());
 }
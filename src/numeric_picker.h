@@ -24,6 +24,10 @@ class NumericPicker : public wxPanel {
 
   void SetValue(int v);
 
+  // Like SetValue, but doesn't send EVT_PICK_NUMBER. This is for showing a
+  // value, rather than picking one.
+  void ChangeValue(int v);
+
  private:
   void OnSliderChanged(wxCommandEvent& event);
   void OnSpinChanged(wxSpinEvent& event);
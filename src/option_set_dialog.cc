@@ -1,7 +1,9 @@
 #include "option_set_dialog.h"
 
+#include "allocation_counter.h"
 #include "double_map.h"
 #include "filterable_item_picker.h"
+#include "trace.h"
 #include "util.h"
 
 OptionSetDialog::OptionSetDialog(const Game* game,
@@ -10,6 +12,9 @@ OptionSetDialog::OptionSetDialog(const Game* game,
     : wxDialog(nullptr, wxID_ANY, "Value Picker"),
       game_(game),
       option_definition_(&game->GetOption(option_name)) {
+  TRACE_SPAN("OptionSetDialog", option_name);
+  ALLOCATION_PROBE("Open dialog");
+
   // Initialize the form.
   wxBoxSizer* top_sizer = new wxBoxSizer(wxVERTICAL);
 
@@ -51,8 +56,8 @@ OptionSetDialog::OptionSetDialog(const Game* game,
 
   const DoubleMap<std::string>& option_set =
       GetOptionSetElements(*game_, option_name);
-  for (int i = 0; i < option_value.set_values.size(); i++) {
-    if (option_value.set_values.at(i)) {
+  for (size_t i = 0; i < option_value.set_values->size(); i++) {
+    if (option_value.set_values->at(i)) {
       std::string str_val = option_set.GetValue(i);
 
       wxVector<wxVariant> data;
@@ -67,10 +72,19 @@ OptionSetDialog::OptionSetDialog(const Game* game,
       new wxButton(lists_sizer->GetStaticBox(), wxID_ANY, "Remove");
   remove_btn->Bind(wxEVT_BUTTON, &OptionSetDialog::OnRemoveClicked, this);
 
+  wxButton* import_btn =
+      new wxButton(lists_sizer->GetStaticBox(), wxID_ANY, "Import...");
+  import_btn->Bind(wxEVT_BUTTON, &OptionSetDialog::OnImportClicked, this);
+
+  wxBoxSizer* buttons_sizer = new wxBoxSizer(wxHORIZONTAL);
+  buttons_sizer->Add(remove_btn);
+  buttons_sizer->AddSpacer(10);
+  buttons_sizer->Add(import_btn);
+
   wxBoxSizer* right_sizer = new wxBoxSizer(wxVERTICAL);
   right_sizer->Add(chosen_list_, wxSizerFlags().Proportion(1).Expand());
   right_sizer->AddSpacer(10);
-  right_sizer->Add(remove_btn, wxSizerFlags().Center());
+  right_sizer->Add(buttons_sizer, wxSizerFlags().Center());
 
   lists_sizer->Add(right_sizer,
                    wxSizerFlags().DoubleBorder().Proportion(1).Expand());
@@ -101,10 +115,11 @@ OptionValue OptionSetDialog::GetOptionValue() const {
       GetOptionSetElements(*game_, option_definition_->name);
 
   OptionValue option_value;
-  option_value.set_values.resize(option_set.size());
+  std::vector<bool>& set_values = option_value.set_values.Mutable();
+  set_values.resize(option_set.size());
 
   for (const std::string& name : picked_) {
-    option_value.set_values[option_set.GetId(name)] = true;
+    set_values[option_set.GetId(name)] = true;
   }
 
   return option_value;
@@ -131,3 +146,39 @@ void OptionSetDialog::OnRemoveClicked(wxCommandEvent& event) {
   picked_.erase(chosen_list_->GetTextValue(selection, 0).ToStdString());
   chosen_list_->DeleteItem(selection);
 }
+
+void OptionSetDialog::OnImportClicked(wxCommandEvent& event) {
+  wxTextEntryDialog import_dialog(
+      this, "Paste a list of values, one per line:", "Import Values", "",
+      wxTextEntryDialogStyle | wxTE_MULTILINE);
+  if (import_dialog.ShowModal() != wxID_OK) {
+    return;
+  }
+
+  const DoubleMap<std::string>& option_set =
+      GetOptionSetElements(*game_, option_definition_->name);
+  BulkImportResult result =
+      ParseBulkImport(option_set, import_dialog.GetValue().ToStdString());
+
+  chosen_list_->Freeze();
+
+  for (const auto& [id, amount] : result.entries) {
+    const std::string& str_val = option_set.GetValue(id);
+    if (amount <= 0 || picked_.count(str_val)) {
+      continue;
+    }
+
+    wxVector<wxVariant> data;
+    data.push_back(wxVariant(str_val));
+    chosen_list_->AppendItem(data);
+
+    picked_.insert(str_val);
+  }
+
+  chosen_list_->Thaw();
+
+  if (!result.unknown.empty()) {
+    wxMessageBox(FormatBulkImportReport(result), "Import Values",
+                 wxOK | wxICON_WARNING, this);
+  }
+}
@@ -26,6 +26,7 @@ class OptionSetDialog : public wxDialog {
  private:
   void OnItemPicked(wxCommandEvent& event);
   void OnRemoveClicked(wxCommandEvent& event);
+  void OnImportClicked(wxCommandEvent& event);
 
   const Game* game_;
   const OptionDefinition* option_definition_;
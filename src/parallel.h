@@ -0,0 +1,73 @@
+#ifndef PARALLEL_H_93D6F0B2
+#define PARALLEL_H_93D6F0B2
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Calls fn(i) for every i in [0, count), spread over up to one thread per
+// core (including the calling thread), and returns once every call has
+// finished. Indices are handed out one at a time, so uneven work balances
+// itself. If any call throws, the remaining indices are skipped and the first
+// exception is rethrown.
+template <typename Fn>
+void ParallelFor(size_t count, Fn fn, size_t max_threads = 0) {
+  if (max_threads == 0) {
+    max_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  size_t thread_count = std::min(max_threads, count);
+  if (thread_count <= 1) {
+    for (size_t i = 0; i < count; i++) {
+      fn(i);
+    }
+
+    return;
+  }
+
+  std::atomic<size_t> next_index = 0;
+  std::mutex exception_mutex;
+  std::exception_ptr exception;
+
+  auto work = [&] {
+    for (;;) {
+      size_t i = next_index++;
+      if (i >= count) {
+        return;
+      }
+
+      try {
+        fn(i);
+      } catch (...) {
+        std::lock_guard lock(exception_mutex);
+        if (!exception) {
+          exception = std::current_exception();
+        }
+
+        next_index = count;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count - 1);
+  for (size_t i = 1; i < thread_count; i++) {
+    threads.emplace_back(work);
+  }
+
+  work();
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+#endif /* end of include guard: PARALLEL_H_93D6F0B2 */
@@ -1,14 +1,19 @@
 #include "random_choice_dialog.h"
 
+#include "allocation_counter.h"
 #include "game_definition.h"
 #include "numeric_picker.h"
+#include "trace.h"
 #include "world.h"
 
 RandomChoiceDialog::RandomChoiceDialog(
     const OptionDefinition* option_definition, const OptionValue& option_value)
     : wxDialog(nullptr, wxID_ANY, "Randomization Settings") {
+  TRACE_SPAN("RandomChoiceDialog", option_definition->name);
+  ALLOCATION_PROBE("Open dialog");
+
   // Load the weights from the option value.
-  for (const OptionValue& weight_value : option_value.weighting) {
+  for (const OptionValue& weight_value : *option_value.weighting) {
     weights_[weight_value.string_value] = weight_value.weight;
   }
 
@@ -18,7 +23,7 @@ RandomChoiceDialog::RandomChoiceDialog(
       continue;
     }
 
-    if (option_value.weighting.empty() &&
+    if (option_value.weighting->empty() &&
         option_name == option_definition->default_value.string_value) {
       weights_[option_name] = 50;
     } else {
@@ -57,7 +62,7 @@ RandomChoiceDialog::RandomChoiceDialog(
       new wxRadioBox(this, wxID_ANY, "Randomization Mode", wxDefaultPosition,
                      wxDefaultSize, 3, mode_choices);
   if (option_value.random) {
-    if (option_value.weighting.empty()) {
+    if (option_value.weighting->empty()) {
       modes_box_->SetSelection(1);
     } else {
       modes_box_->SetSelection(2);
@@ -102,7 +107,7 @@ RandomChoiceDialog::RandomChoiceDialog(
   top_sizer->Add(weighted_panel_, wxSizerFlags().DoubleBorder().Expand());
   top_sizer->Add(CreateButtonSizer(wxOK | wxCANCEL), wxSizerFlags().Expand());
 
-  if (!(option_value.random && !option_value.weighting.empty())) {
+  if (!(option_value.random && !option_value.weighting->empty())) {
     weighted_panel_->Disable();
   }
 
@@ -152,7 +157,7 @@ OptionValue RandomChoiceDialog::GetOptionValue() const {
         sub_option.string_value = option_value;
       }
 
-      result.weighting.push_back(sub_option);
+      result.weighting.Mutable().push_back(sub_option);
     }
   }
 
@@ -2,8 +2,10 @@
 
 #include <wx/spinctrl.h>
 
+#include "allocation_counter.h"
 #include "game_definition.h"
 #include "numeric_picker.h"
+#include "trace.h"
 #include "util.h"
 #include "world.h"
 
@@ -109,6 +111,9 @@ RandomRangeDialog::RandomRangeDialog(const OptionDefinition* option_definition,
                                      const OptionValue& option_value)
     : wxDialog(nullptr, wxID_ANY, "Randomization Settings"),
       option_definition_(option_definition) {
+  TRACE_SPAN("RandomRangeDialog", option_definition->name);
+  ALLOCATION_PROBE("Open dialog");
+
   // Initialise the form.
   wxBoxSizer* top_sizer = new wxBoxSizer(wxVERTICAL);
 
@@ -176,7 +181,7 @@ RandomRangeDialog::RandomRangeDialog(const OptionDefinition* option_definition,
   regular_affinity_sizer->AddSpacer(5);
   regular_affinity_sizer->Add(high_button);
 
-  if (option_value.random && option_value.weighting.empty()) {
+  if (option_value.random && option_value.weighting->empty()) {
     chosen_random_type_ = option_value.range_random_type;
 
     switch (option_value.range_random_type) {
@@ -238,7 +243,7 @@ RandomRangeDialog::RandomRangeDialog(const OptionDefinition* option_definition,
     subset_max_->Enable(enable_range_subset_->GetValue());
   });
 
-  if (option_value.random && option_value.weighting.empty() &&
+  if (option_value.random && option_value.weighting->empty() &&
       option_value.range_subset) {
     enable_range_subset_->SetValue(true);
   } else {
@@ -344,8 +349,8 @@ RandomRangeDialog::RandomRangeDialog(const OptionDefinition* option_definition,
   });
 
   // Load the weights from the option value.
-  if (option_value.random && !option_value.weighting.empty()) {
-    for (const OptionValue& weight_value : option_value.weighting) {
+  if (option_value.random && !option_value.weighting->empty()) {
+    for (const OptionValue& weight_value : *option_value.weighting) {
       AddWeightRow(RrdValue(weight_value), weighted_box_sizer->GetStaticBox(),
                    weighted_sizer_, weight_value.weight);
     }
@@ -357,7 +362,7 @@ RandomRangeDialog::RandomRangeDialog(const OptionDefinition* option_definition,
     default_rrd_value.static_value = option_definition->default_value.int_value;
 
     if (!weights_.count(default_rrd_value)) {
-      int default_value = option_value.weighting.empty() ? 50 : 0;
+      int default_value = option_value.weighting->empty() ? 50 : 0;
       AddWeightRow(default_rrd_value, weighted_box_sizer->GetStaticBox(),
                    weighted_sizer_, default_value);
     }
@@ -404,7 +409,7 @@ RandomRangeDialog::RandomRangeDialog(const OptionDefinition* option_definition,
 
   // Enable the form based on the option value.
   if (option_value.random) {
-    if (option_value.weighting.empty()) {
+    if (option_value.weighting->empty()) {
       modes_box_->SetSelection(1);
 
       regular_panel_->Enable();
@@ -517,7 +522,7 @@ OptionValue RandomRangeDialog::GetOptionValue() const {
       OptionValue sub_option = rrd_value.ToOptionValue();
       sub_option.weight = weight.weight;
 
-      result.weighting.push_back(sub_option);
+      result.weighting.Mutable().push_back(sub_option);
     }
   }
 
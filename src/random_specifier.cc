@@ -0,0 +1,99 @@
+#include "random_specifier.h"
+
+// The parser and formatter are constexpr, so their behaviour is checked here
+// at compile time.
+namespace {
+
+constexpr RandomSpecifier MakeSpecifier(
+    bool random, RandomValueType type,
+    std::optional<std::tuple<int, int>> range = std::nullopt,
+    std::optional<DiagnosticCode> error = std::nullopt) {
+  RandomSpecifier specifier;
+  specifier.random = random;
+  specifier.type = type;
+  specifier.range = range;
+  specifier.error = error;
+
+  return specifier;
+}
+
+constexpr RandomSpecifier MakeError(DiagnosticCode error,
+                                    RandomValueType type = kUniformRandom) {
+  return MakeSpecifier(true, type, std::nullopt, error);
+}
+
+constexpr std::tuple<int, int> Range(int low, int high) { return {low, high}; }
+
+constexpr bool RoundTrips(std::string_view descriptor) {
+  RandomSpecifier specifier = ParseRandomSpecifier(descriptor);
+  return FormatRandomSpecifier(specifier.type, specifier.range).view() ==
+         descriptor;
+}
+
+static_assert(ParseRandomSpecifier("random") ==
+              MakeSpecifier(true, kUniformRandom));
+static_assert(ParseRandomSpecifier("random-") ==
+              MakeSpecifier(true, kUniformRandom));
+static_assert(ParseRandomSpecifier("random-low") ==
+              MakeSpecifier(true, kLowRandom));
+static_assert(ParseRandomSpecifier("random-middle") ==
+              MakeSpecifier(true, kMiddleRandom));
+static_assert(ParseRandomSpecifier("random-high") ==
+              MakeSpecifier(true, kHighRandom));
+static_assert(ParseRandomSpecifier("random-range-5-10") ==
+              MakeSpecifier(true, kUniformRandom, Range(5, 10)));
+static_assert(ParseRandomSpecifier("random-range-low-5-10") ==
+              MakeSpecifier(true, kLowRandom, Range(5, 10)));
+static_assert(ParseRandomSpecifier("random-range-middle-0-2147483647") ==
+              MakeSpecifier(true, kMiddleRandom, Range(0, 2147483647)));
+static_assert(ParseRandomSpecifier("random-range-high-1-1") ==
+              MakeSpecifier(true, kHighRandom, Range(1, 1)));
+static_assert(ParseRandomSpecifier("random-range--10-1000") ==
+              MakeSpecifier(true, kUniformRandom, Range(-10, 1000)));
+static_assert(ParseRandomSpecifier("random-range-low--2147483648--1") ==
+              MakeSpecifier(true, kLowRandom, Range(-2147483647 - 1, -1)));
+
+static_assert(ParseRandomSpecifier("") ==
+              MakeSpecifier(false, kUNKNOWN_RANDOM_VALUE_TYPE, std::nullopt,
+                            DiagnosticCode::kMalformedRandom));
+static_assert(ParseRandomSpecifier("randomly") ==
+              MakeSpecifier(false, kUNKNOWN_RANDOM_VALUE_TYPE, std::nullopt,
+                            DiagnosticCode::kMalformedRandom));
+static_assert(ParseRandomSpecifier("random-range") ==
+              MakeError(DiagnosticCode::kRandomMissingBounds));
+static_assert(ParseRandomSpecifier("random-range-low") ==
+              MakeError(DiagnosticCode::kRandomMissingBounds, kLowRandom));
+static_assert(ParseRandomSpecifier("random-range-5") ==
+              MakeError(DiagnosticCode::kRandomMissingMax));
+static_assert(ParseRandomSpecifier("random-range-x-5") ==
+              MakeError(DiagnosticCode::kRandomMinNotNumeric));
+static_assert(ParseRandomSpecifier("random-range-5-x") ==
+              MakeError(DiagnosticCode::kRandomMaxNotNumeric));
+static_assert(ParseRandomSpecifier("random-range-1-2147483648") ==
+              MakeError(DiagnosticCode::kRandomMaxNotNumeric));
+static_assert(ParseRandomSpecifier("random-range--2147483649-0") ==
+              MakeError(DiagnosticCode::kRandomMinNotNumeric));
+static_assert(ParseRandomSpecifier("random-range--x-5") ==
+              MakeError(DiagnosticCode::kRandomMinNotNumeric));
+static_assert(ParseRandomSpecifier("random-range-5--") ==
+              MakeError(DiagnosticCode::kRandomMaxNotNumeric));
+static_assert(ParseRandomSpecifier("random--5") ==
+              MakeError(DiagnosticCode::kMalformedRandom));
+static_assert(ParseRandomSpecifier("random-range-5-10-15") ==
+              MakeSpecifier(true, kUniformRandom, Range(5, 10),
+                            DiagnosticCode::kMalformedRandom));
+static_assert(ParseRandomSpecifier("random-sideways") ==
+              MakeError(DiagnosticCode::kMalformedRandom));
+
+static_assert(RoundTrips("random"));
+static_assert(RoundTrips("random-low"));
+static_assert(RoundTrips("random-high"));
+static_assert(RoundTrips("random-range-0-100"));
+static_assert(RoundTrips("random-range-middle-2147483647-2147483647"));
+static_assert(RoundTrips("random-range--10-1000"));
+static_assert(RoundTrips("random-range-high--5--5"));
+static_assert(FormatRandomSpecifier(kLowRandom, Range(-2147483647 - 1, -1))
+                  .view() == "random-range-low--2147483648--1");
+static_assert(RoundTrips("random-range-low--2147483648--1"));
+
+}  // namespace
@@ -0,0 +1,236 @@
+#ifndef RANDOM_SPECIFIER_H_8E2A47C9
+#define RANDOM_SPECIFIER_H_8E2A47C9
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <tuple>
+
+#include "diagnostic.h"
+#include "game_definition.h"
+
+// A parsed random specifier for range options, such as "random",
+// "random-high" or "random-range-low-5-10".
+struct RandomSpecifier {
+  bool random = false;
+  RandomValueType type = kUNKNOWN_RANDOM_VALUE_TYPE;
+  std::optional<std::tuple<int, int>> range;  // low, high
+  std::optional<DiagnosticCode> error;
+
+  constexpr bool operator==(const RandomSpecifier&) const = default;
+};
+
+// The formatted form of a specifier, stored inline so that formatting never
+// allocates. The longest possible specifier is
+// "random-range-middle-" followed by two ten-digit numbers with signs.
+struct RandomSpecifierText {
+  char data[48] = {};
+  size_t size = 0;
+
+  constexpr std::string_view view() const { return {data, size}; }
+};
+
+namespace random_specifier_internal {
+
+// Hands out the "-"-separated parts of a specifier. A trailing "-" does not
+// produce an empty part, and a "-" before a digit at the start of a part is
+// the sign of a negative number rather than a separator.
+class Tokenizer {
+ public:
+  constexpr explicit Tokenizer(std::string_view text) : rest_(text) {}
+
+  constexpr bool Next(std::string_view& token) {
+    if (rest_.empty()) {
+      return false;
+    }
+
+    bool has_sign = rest_.size() > 1 && rest_[0] == '-' && rest_[1] >= '0' &&
+                    rest_[1] <= '9';
+    size_t divider = rest_.find('-', has_sign ? 1 : 0);
+    if (divider == std::string_view::npos) {
+      token = rest_;
+      rest_ = {};
+    } else {
+      token = rest_.substr(0, divider);
+      rest_.remove_prefix(divider + 1);
+    }
+
+    return true;
+  }
+
+ private:
+  std::string_view rest_;
+};
+
+// std::from_chars is not constexpr until C++23.
+constexpr std::optional<int> ParseInt(std::string_view text) {
+  bool negative = !text.empty() && text.front() == '-';
+  if (negative) {
+    text.remove_prefix(1);
+  }
+
+  if (text.empty()) {
+    return std::nullopt;
+  }
+
+  // The smallest int has no positive counterpart.
+  long long limit = negative ? 2147483648LL : 2147483647LL;
+
+  long long value = 0;
+  for (char ch : text) {
+    if (ch < '0' || ch > '9') {
+      return std::nullopt;
+    }
+
+    value = value * 10 + (ch - '0');
+    if (value > limit) {
+      return std::nullopt;
+    }
+  }
+
+  return static_cast<int>(negative ? -value : value);
+}
+
+constexpr void AppendText(RandomSpecifierText& text, std::string_view part) {
+  for (char ch : part) {
+    text.data[text.size++] = ch;
+  }
+}
+
+constexpr void AppendInt(RandomSpecifierText& text, int value) {
+  // Widened so that the smallest int can be negated.
+  long long magnitude = value;
+  if (magnitude < 0) {
+    text.data[text.size++] = '-';
+    magnitude = -magnitude;
+  }
+
+  char digits[10] = {};
+  size_t digit_count = 0;
+  do {
+    digits[digit_count++] = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude > 0);
+
+  while (digit_count > 0) {
+    text.data[text.size++] = digits[--digit_count];
+  }
+}
+
+}  // namespace random_specifier_internal
+
+constexpr RandomSpecifier ParseRandomSpecifier(std::string_view descriptor) {
+  using random_specifier_internal::ParseInt;
+
+  RandomSpecifier result;
+  random_specifier_internal::Tokenizer tokenizer(descriptor);
+
+  std::string_view part;
+  bool has_part = tokenizer.Next(part);
+  if (!has_part) {
+    result.error = DiagnosticCode::kMalformedRandom;
+    return result;
+  }
+
+  if (part == "random") {
+    result.random = true;
+    result.type = kUniformRandom;
+
+    has_part = tokenizer.Next(part);
+  }
+
+  if (!has_part) {
+    return result;
+  }
+
+  bool is_range = false;
+  if (part == "range") {
+    is_range = true;
+
+    // It's an error for there to be no parts after "range".
+    has_part = tokenizer.Next(part);
+    if (!has_part) {
+      result.error = DiagnosticCode::kRandomMissingBounds;
+      return result;
+    }
+  }
+
+  if (part == "low" || part == "middle" || part == "high") {
+    if (part == "low") {
+      result.type = kLowRandom;
+    } else if (part == "middle") {
+      result.type = kMiddleRandom;
+    } else {
+      result.type = kHighRandom;
+    }
+
+    has_part = tokenizer.Next(part);
+  }
+
+  if (is_range) {
+    if (!has_part) {
+      result.error = DiagnosticCode::kRandomMissingBounds;
+      return result;
+    }
+
+    std::string_view max_part;
+    if (!tokenizer.Next(max_part)) {
+      result.error = DiagnosticCode::kRandomMissingMax;
+      return result;
+    }
+
+    std::optional<int> min = ParseInt(part);
+    if (!min) {
+      result.error = DiagnosticCode::kRandomMinNotNumeric;
+      return result;
+    }
+
+    std::optional<int> max = ParseInt(max_part);
+    if (!max) {
+      result.error = DiagnosticCode::kRandomMaxNotNumeric;
+      return result;
+    }
+
+    result.range = std::tuple<int, int>(*min, *max);
+
+    has_part = tokenizer.Next(part);
+  }
+
+  if (has_part) {
+    result.error = DiagnosticCode::kMalformedRandom;
+  }
+
+  return result;
+}
+
+constexpr RandomSpecifierText FormatRandomSpecifier(
+    RandomValueType type, const std::optional<std::tuple<int, int>>& range) {
+  using random_specifier_internal::AppendInt;
+  using random_specifier_internal::AppendText;
+
+  RandomSpecifierText text;
+  AppendText(text, "random");
+
+  if (range) {
+    AppendText(text, "-range");
+  }
+
+  if (type == kLowRandom) {
+    AppendText(text, "-low");
+  } else if (type == kMiddleRandom) {
+    AppendText(text, "-middle");
+  } else if (type == kHighRandom) {
+    AppendText(text, "-high");
+  }
+
+  if (range) {
+    AppendText(text, "-");
+    AppendInt(text, std::get<0>(*range));
+    AppendText(text, "-");
+    AppendInt(text, std::get<1>(*range));
+  }
+
+  return text;
+}
+
+#endif /* end of include guard: RANDOM_SPECIFIER_H_8E2A47C9 */
@@ -0,0 +1,135 @@
+// ap_wizard_replay: plays a recorded session back against the wizard's
+// windows, and writes a JSON report of how long each step took.
+
+#include <wx/wxprec.h>
+
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "game_definition.h"
+#include "session_replayer.h"
+#include "session_script.h"
+#include "wizard_frame.h"
+
+namespace {
+
+constexpr const char* kUsage =
+    "Usage: ap_wizard_replay [options] SCRIPT\n"
+    "\n"
+    "Replays a session recorded with AP_WIZARD_RECORD, and writes a JSON\n"
+    "report of each step's latency.\n"
+    "\n"
+    "Options:\n"
+    "  --definitions FILE  the dumped-options.json to load\n"
+    "                      (default: the one next to this executable)\n"
+    "  --output FILE       where to write the report (default: stdout)\n";
+
+// Exit codes.
+constexpr int kReplayed = 0;
+constexpr int kReplayFailed = 1;
+constexpr int kUsageError = 2;
+
+}  // namespace
+
+class ReplayApp : public wxApp {
+ public:
+  bool OnInit() override {
+    std::string script_filename;
+    std::string definitions_filename;
+
+    for (int i = 1; i < argc; i++) {
+      std::string arg = argv[i].ToStdString();
+
+      if (arg == "--definitions" && i + 1 < argc) {
+        definitions_filename = argv[++i].ToStdString();
+      } else if (arg == "--output" && i + 1 < argc) {
+        output_filename_ = argv[++i].ToStdString();
+      } else if (arg.starts_with("--") || !script_filename.empty()) {
+        std::cerr << kUsage;
+        exit_code_ = kUsageError;
+        return false;
+      } else {
+        script_filename = arg;
+      }
+    }
+
+    if (script_filename.empty()) {
+      std::cerr << kUsage;
+      exit_code_ = kUsageError;
+      return false;
+    }
+
+    std::unique_ptr<GameDefinitions> game_definitions;
+    try {
+      steps_ = ReadSessionScript(script_filename);
+      game_definitions =
+          definitions_filename.empty()
+              ? std::make_unique<GameDefinitions>()
+              : std::make_unique<GameDefinitions>(definitions_filename);
+    } catch (const std::exception& ex) {
+      std::cerr << ex.what() << std::endl;
+      exit_code_ = kUsageError;
+      return false;
+    }
+
+    frame_ = new WizardFrame(std::move(game_definitions));
+    frame_->Show(true);
+
+    // The frame has to be shown and laid out before the first step is timed.
+    CallAfter([this] { RunReplay(); });
+
+    return true;
+  }
+
+  int OnRun() override {
+    wxApp::OnRun();
+
+    return exit_code_;
+  }
+
+ private:
+  void RunReplay() {
+    nlohmann::ordered_json report;
+
+    {
+      SessionReplayer replayer(frame_);
+      try {
+        replayer.Replay(steps_);
+      } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        exit_code_ = kReplayFailed;
+      }
+
+      report = replayer.GetReport();
+    }
+
+    if (output_filename_.empty()) {
+      std::cout << report.dump(2) << std::endl;
+    } else {
+      std::ofstream output(output_filename_);
+      output << report.dump(2) << std::endl;
+
+      if (!output) {
+        std::cerr << "Could not write \"" << output_filename_ << "\"."
+                  << std::endl;
+        exit_code_ = kUsageError;
+      }
+    }
+
+    // Worlds changed by the replay are thrown away without asking.
+    frame_->Destroy();
+  }
+
+  std::string output_filename_;
+  std::vector<SessionStep> steps_;
+  WizardFrame* frame_ = nullptr;
+  int exit_code_ = kReplayed;
+};
+
+wxIMPLEMENT_APP(ReplayApp);
@@ -0,0 +1,182 @@
+#include "session_replayer.h"
+
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+
+#include "filterable_item_picker.h"
+#include "item_dict_dialog.h"
+#include "option_set_dialog.h"
+#include "random_choice_dialog.h"
+#include "random_range_dialog.h"
+#include "wizard_editor.h"
+#include "wizard_frame.h"
+#include "world_window.h"
+
+namespace {
+
+FilterableItemPicker* FindItemPicker(wxWindow* window) {
+  if (FilterableItemPicker* picker =
+          dynamic_cast<FilterableItemPicker*>(window)) {
+    return picker;
+  }
+
+  for (wxWindow* child : window->GetChildren()) {
+    if (FilterableItemPicker* picker = FindItemPicker(child)) {
+      return picker;
+    }
+  }
+
+  return nullptr;
+}
+
+}  // namespace
+
+SessionReplayer::SessionReplayer(WizardFrame* frame) : frame_(frame) {
+  frame_->SetInteractive(false);
+}
+
+SessionReplayer::~SessionReplayer() {
+  if (dialog_) {
+    dialog_->Destroy();
+  }
+}
+
+void SessionReplayer::Replay(const std::vector<SessionStep>& steps) {
+  for (size_t i = 0; i < steps.size(); i++) {
+    const SessionStep& step = steps[i];
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+      ApplyStep(step);
+    } catch (const std::exception& ex) {
+      throw std::runtime_error("Step " + std::to_string(i + 1) + " (" +
+                               GetSessionStepName(step.type) +
+                               "): " + ex.what());
+    }
+
+    // Rebuilds are only finished once the windows have been laid out and
+    // painted.
+    frame_->Update();
+    if (dialog_) {
+      dialog_->Update();
+    }
+    wxYield();
+
+    std::chrono::duration<double, std::milli> time =
+        std::chrono::steady_clock::now() - start;
+    histograms_[step.type].Add(time.count());
+
+    nlohmann::ordered_json step_report;
+    step_report["step"] = GetSessionStepName(step.type);
+    step_report["milliseconds"] = time.count();
+    steps_report_.push_back(std::move(step_report));
+  }
+}
+
+nlohmann::ordered_json SessionReplayer::GetReport() const {
+  nlohmann::ordered_json by_step;
+  for (const auto& [type, histogram] : histograms_) {
+    by_step[GetSessionStepName(type)] = histogram.ToJson();
+  }
+
+  nlohmann::ordered_json report;
+  report["by_step"] = std::move(by_step);
+  report["steps"] = steps_report_;
+
+  return report;
+}
+
+void SessionReplayer::ApplyStep(const SessionStep& step) {
+  if (step.type == SessionStepType::kOpen) {
+    frame_->LoadWorlds(step.files);
+
+    return;
+  } else if (step.type == SessionStepType::kNewWorld) {
+    frame_->InitializeWorld(
+        std::make_unique<World>(frame_->game_definitions_.get()));
+
+    return;
+  } else if (step.type == SessionStepType::kSelectWorld) {
+    if (!frame_->SelectWorld(step.index)) {
+      throw std::runtime_error("There is no world " +
+                               std::to_string(step.index) + ".");
+    }
+
+    return;
+  } else if (step.type == SessionStepType::kSwitchTab) {
+    frame_->world_window_->SetSelection(step.index);
+
+    return;
+  } else if (step.type == SessionStepType::kCloseDialog) {
+    if (dialog_) {
+      dialog_->Destroy();
+      dialog_ = nullptr;
+    }
+
+    return;
+  } else if (step.type == SessionStepType::kFilter) {
+    FilterableItemPicker* picker =
+        dialog_ ? FindItemPicker(dialog_) : nullptr;
+    if (!picker) {
+      throw std::runtime_error("No item picker is open.");
+    }
+
+    picker->SetFilter(step.text);
+
+    return;
+  }
+
+  // The rest of the steps act on the selected world.
+  World* world = frame_->GetSelectedWorld();
+  if (!world) {
+    throw std::runtime_error("No world is selected.");
+  }
+
+  // These were recorded by the form, so they are made through it too.
+  WizardEditor* wizard_editor = frame_->world_window_->GetWizardEditor();
+
+  if (step.type == SessionStepType::kSetGame) {
+    wizard_editor->ReplaySetGame(step.game);
+  } else if (step.type == SessionStepType::kApplyPreset) {
+    wizard_editor->ReplayApplyPreset(step.preset);
+  } else if (step.type == SessionStepType::kSetOption) {
+    std::optional<OptionValue> option_value;
+    if (!step.value.empty()) {
+      const Game& game = frame_->game_definitions_->GetGame(world->GetGame());
+      option_value = OptionValueFromYaml(game, step.option, step.value);
+    }
+
+    wizard_editor->ReplaySetOption(step.option, std::move(option_value));
+  } else if (step.type == SessionStepType::kOpenDialog) {
+    if (dialog_) {
+      throw std::runtime_error("A dialog is already open.");
+    }
+
+    const Game& game = frame_->game_definitions_->GetGame(world->GetGame());
+    const OptionDefinition& game_option = game.GetOption(step.option);
+    const OptionValue& option_value = world->HasOption(step.option)
+                                          ? world->GetOption(step.option)
+                                          : game_option.default_value;
+
+    if (game_option.type == kSelectOption) {
+      dialog_ = new RandomChoiceDialog(&game_option, option_value);
+    } else if (game_option.type == kRangeOption) {
+      dialog_ = new RandomRangeDialog(&game_option, option_value);
+    } else if (game_option.type == kDictOption) {
+      dialog_ = new ItemDictDialog(&game, step.option, option_value);
+    } else {
+      dialog_ = new OptionSetDialog(&game, step.option, option_value);
+    }
+
+    dialog_->Show();
+  } else if (step.type == SessionStepType::kSave) {
+    if (!step.file.empty()) {
+      world->SetFilename(step.file);
+    } else if (!world->HasFilename()) {
+      throw std::runtime_error("The world has no file to save to.");
+    }
+
+    frame_->AttemptSaveWorld(*world, /*force_dialog=*/false, /*wait=*/true);
+  }
+}
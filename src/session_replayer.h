@@ -0,0 +1,48 @@
+#ifndef SESSION_REPLAYER_H_3B9F04D7
+#define SESSION_REPLAYER_H_3B9F04D7
+
+#include <wx/wxprec.h>
+
+#ifndef WX_PRECOMP
+#include <wx/wx.h>
+#endif
+
+#include <map>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+#include "latency_histogram.h"
+#include "session_script.h"
+
+class WizardFrame;
+
+// Plays a session script back against a frame, timing each step from the
+// start of the change until the windows have been laid out and repainted.
+//
+// Steps go through the frame's and editor's own methods rather than
+// simulated input, so a dialog is shown modelessly and stays open until the
+// next close_dialog step. The frame is made non-interactive, so errors are
+// written to stderr rather than shown in message boxes.
+class SessionReplayer {
+ public:
+  explicit SessionReplayer(WizardFrame* frame);
+
+  ~SessionReplayer();
+
+  // Throws std::runtime_error, naming the step, if a step can't be applied.
+  void Replay(const std::vector<SessionStep>& steps);
+
+  // The latency of each step type, and of each step in order.
+  nlohmann::ordered_json GetReport() const;
+
+ private:
+  void ApplyStep(const SessionStep& step);
+
+  WizardFrame* frame_;
+  wxDialog* dialog_ = nullptr;
+
+  std::map<SessionStepType, LatencyHistogram> histograms_;
+  nlohmann::ordered_json steps_report_ = nlohmann::ordered_json::array();
+};
+
+#endif /* end of include guard: SESSION_REPLAYER_H_3B9F04D7 */
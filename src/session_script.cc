@@ -0,0 +1,196 @@
+#include "session_script.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+namespace {
+
+constexpr SessionStepType kAllStepTypes[] = {
+    SessionStepType::kOpen,        SessionStepType::kNewWorld,
+    SessionStepType::kSelectWorld, SessionStepType::kSetGame,
+    SessionStepType::kApplyPreset, SessionStepType::kSetOption,
+    SessionStepType::kOpenDialog,  SessionStepType::kFilter,
+    SessionStepType::kCloseDialog, SessionStepType::kSwitchTab,
+    SessionStepType::kSave,
+};
+
+std::ofstream* GetRecording() {
+  static std::ofstream* recording = []() -> std::ofstream* {
+    const char* filename = std::getenv("AP_WIZARD_RECORD");
+    if (filename == nullptr || *filename == '\0') {
+      return nullptr;
+    }
+
+    return new std::ofstream(filename);
+  }();
+
+  return recording;
+}
+
+}  // namespace
+
+const char* GetSessionStepName(SessionStepType type) {
+  switch (type) {
+    case SessionStepType::kOpen: {
+      return "open";
+    }
+    case SessionStepType::kNewWorld: {
+      return "new_world";
+    }
+    case SessionStepType::kSelectWorld: {
+      return "select_world";
+    }
+    case SessionStepType::kSetGame: {
+      return "set_game";
+    }
+    case SessionStepType::kApplyPreset: {
+      return "apply_preset";
+    }
+    case SessionStepType::kSetOption: {
+      return "set_option";
+    }
+    case SessionStepType::kOpenDialog: {
+      return "open_dialog";
+    }
+    case SessionStepType::kFilter: {
+      return "filter";
+    }
+    case SessionStepType::kCloseDialog: {
+      return "close_dialog";
+    }
+    case SessionStepType::kSwitchTab: {
+      return "switch_tab";
+    }
+    case SessionStepType::kSave: {
+      return "save";
+    }
+  }
+
+  return "unknown";
+}
+
+SessionStep ParseSessionStep(std::string_view line) {
+  nlohmann::json data = nlohmann::json::parse(line, nullptr,
+                                              /*allow_exceptions=*/false);
+  if (!data.is_object() || !data.contains("step") ||
+      !data["step"].is_string()) {
+    throw std::invalid_argument(
+        "Each step should be an object with a \"step\".");
+  }
+
+  SessionStep step;
+
+  std::string name = data["step"];
+  bool found = false;
+  for (SessionStepType type : kAllStepTypes) {
+    if (name == GetSessionStepName(type)) {
+      step.type = type;
+      found = true;
+      break;
+    }
+  }
+
+  if (!found) {
+    throw std::invalid_argument("Unknown step \"" + name + "\".");
+  }
+
+  try {
+    step.files = data.value("files", std::vector<std::string>());
+    step.index = data.value("index", size_t(0));
+    step.game = data.value("game", "");
+    step.preset = data.value("preset", "");
+    step.option = data.value("option", "");
+    step.value = data.value("value", "");
+    step.text = data.value("text", "");
+    step.file = data.value("file", "");
+  } catch (const nlohmann::json::exception&) {
+    throw std::invalid_argument("The \"" + name +
+                                "\" step has a field of the wrong type.");
+  }
+
+  return step;
+}
+
+std::string FormatSessionStep(const SessionStep& step) {
+  nlohmann::ordered_json data;
+  data["step"] = GetSessionStepName(step.type);
+
+  switch (step.type) {
+    case SessionStepType::kOpen: {
+      data["files"] = step.files;
+      break;
+    }
+    case SessionStepType::kSelectWorld:
+    case SessionStepType::kSwitchTab: {
+      data["index"] = step.index;
+      break;
+    }
+    case SessionStepType::kSetGame: {
+      data["game"] = step.game;
+      break;
+    }
+    case SessionStepType::kApplyPreset: {
+      data["preset"] = step.preset;
+      break;
+    }
+    case SessionStepType::kSetOption: {
+      data["option"] = step.option;
+      data["value"] = step.value;
+      break;
+    }
+    case SessionStepType::kOpenDialog: {
+      data["option"] = step.option;
+      break;
+    }
+    case SessionStepType::kFilter: {
+      data["text"] = step.text;
+      break;
+    }
+    case SessionStepType::kSave: {
+      if (!step.file.empty()) {
+        data["file"] = step.file;
+      }
+      break;
+    }
+    case SessionStepType::kNewWorld:
+    case SessionStepType::kCloseDialog: {
+      break;
+    }
+  }
+
+  return data.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+std::vector<SessionStep> ReadSessionScript(const std::string& filename) {
+  std::ifstream file(filename);
+  if (!file) {
+    throw std::runtime_error("Could not open \"" + filename + "\".");
+  }
+
+  std::vector<SessionStep> steps;
+  std::string line;
+  for (int line_number = 1; std::getline(file, line); line_number++) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+
+    try {
+      steps.push_back(ParseSessionStep(line));
+    } catch (const std::exception& ex) {
+      throw std::runtime_error(filename + ":" + std::to_string(line_number) +
+                               ": " + ex.what());
+    }
+  }
+
+  return steps;
+}
+
+bool IsRecordingSession() { return GetRecording() != nullptr; }
+
+void RecordSessionStep(const SessionStep& step) {
+  if (std::ofstream* recording = GetRecording()) {
+    *recording << FormatSessionStep(step) << std::endl;
+  }
+}
@@ -0,0 +1,69 @@
+#ifndef SESSION_SCRIPT_H_E0A6C35B
+#define SESSION_SCRIPT_H_E0A6C35B
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A recorded or hand-written session in the wizard, which ap_wizard_replay can
+// play back to time the UI. Scripts have one JSON object per line, such as
+//
+//   {"step":"open","files":["/path/to/player.yaml"]}
+//   {"step":"select_world","index":0}
+//   {"step":"set_option","option":"goal","value":"goal: ganon\n"}
+//   {"step":"open_dialog","option":"start_inventory"}
+//   {"step":"filter","text":"bow"}
+//   {"step":"close_dialog"}
+//
+// Option values are written as a one-entry YAML map, as the option would
+// appear in the game's section; an empty value unsets the option.
+
+enum class SessionStepType {
+  kOpen,
+  kNewWorld,
+  kSelectWorld,
+  kSetGame,
+  kApplyPreset,
+  kSetOption,
+  kOpenDialog,
+  kFilter,
+  kCloseDialog,
+  kSwitchTab,
+  kSave,
+};
+
+struct SessionStep {
+  SessionStepType type = SessionStepType::kNewWorld;
+
+  std::vector<std::string> files;  // open
+  size_t index = 0;                // select_world, switch_tab
+  std::string game;                // set_game (empty to unset it)
+  std::string preset;              // apply_preset
+  std::string option;              // set_option, open_dialog
+  std::string value;               // set_option
+  std::string text;                // filter
+  std::string file;                // save (empty to keep the world's own)
+};
+
+const char* GetSessionStepName(SessionStepType type);
+
+// Throws std::invalid_argument if the line isn't a valid step.
+SessionStep ParseSessionStep(std::string_view line);
+
+// Formats the step as a single line, without the line break.
+std::string FormatSessionStep(const SessionStep& step);
+
+// Skips blank lines. Throws std::runtime_error, naming the line, if the file
+// can't be read or a step is invalid.
+std::vector<SessionStep> ReadSessionScript(const std::string& filename);
+
+// Whether the AP_WIZARD_RECORD environment variable names a file to record
+// the session into.
+bool IsRecordingSession();
+
+// Appends the step to the recording, if there is one. The file is flushed
+// after every step, so that a crash doesn't lose the session leading up to it.
+void RecordSessionStep(const SessionStep& step);
+
+#endif /* end of include guard: SESSION_SCRIPT_H_E0A6C35B */
@@ -0,0 +1,58 @@
+#ifndef STRING_VIEW_STREAM_H_2F8E6B15
+#define STRING_VIEW_STREAM_H_2F8E6B15
+
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+
+// Read-only stream buffer over memory owned by someone else. Used to hand a
+// document to yaml-cpp without copying it first.
+class StringViewStreamBuf : public std::streambuf {
+ public:
+  explicit StringViewStreamBuf(std::string_view text) {
+    char* begin = const_cast<char*>(text.data());
+    setg(begin, begin, begin + text.size());
+  }
+
+ protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                   std::ios_base::openmode which) override {
+    if (!(which & std::ios_base::in)) {
+      return pos_type(off_type(-1));
+    }
+
+    char* target;
+    if (dir == std::ios_base::beg) {
+      target = eback() + off;
+    } else if (dir == std::ios_base::cur) {
+      target = gptr() + off;
+    } else {
+      target = egptr() + off;
+    }
+
+    if (target < eback() || target > egptr()) {
+      return pos_type(off_type(-1));
+    }
+
+    setg(eback(), target, egptr());
+    return pos_type(target - eback());
+  }
+
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+    return seekoff(off_type(pos), std::ios_base::beg, which);
+  }
+};
+
+class StringViewIStream : public std::istream {
+ public:
+  explicit StringViewIStream(std::string_view text)
+      : std::istream(nullptr), buffer_(text) {
+    rdbuf(&buffer_);
+  }
+
+ private:
+  StringViewStreamBuf buffer_;
+};
+
+#endif /* end of include guard: STRING_VIEW_STREAM_H_2F8E6B15 */
@@ -0,0 +1,102 @@
+#include "timing_stats.h"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+namespace {
+
+// How many of the latest timings are kept for each operation.
+constexpr size_t kRecentCount = 16;
+
+struct OperationTimings {
+  size_t count = 0;
+  double total_milliseconds = 0;
+  double max_milliseconds = 0;
+
+  std::array<double, kRecentCount> recent_milliseconds = {};
+  size_t next_recent = 0;
+};
+
+std::mutex timings_mutex;
+std::array<OperationTimings, kTimedOperationCount> timings;
+
+}  // namespace
+
+const char* GetTimedOperationName(TimedOperation operation) {
+  switch (operation) {
+    case TimedOperation::kCatalogLoad: {
+      return "Option data load";
+    }
+    case TimedOperation::kWorldLoad: {
+      return "World load";
+    }
+    case TimedOperation::kWorldParse: {
+      return "World parse";
+    }
+    case TimedOperation::kFileSave: {
+      return "File save";
+    }
+    case TimedOperation::kFormRebuild: {
+      return "Form rebuild";
+    }
+    case TimedOperation::kFilterQuery: {
+      return "Filter query";
+    }
+  }
+
+  return "Unknown";
+}
+
+void RecordTiming(TimedOperation operation,
+                  std::chrono::steady_clock::duration duration) {
+  double milliseconds =
+      std::chrono::duration<double, std::milli>(duration).count();
+
+  std::lock_guard lock(timings_mutex);
+  OperationTimings& operation_timings =
+      timings[static_cast<size_t>(operation)];
+
+  operation_timings.count++;
+  operation_timings.total_milliseconds += milliseconds;
+  operation_timings.max_milliseconds =
+      std::max(operation_timings.max_milliseconds, milliseconds);
+
+  operation_timings.recent_milliseconds[operation_timings.next_recent] =
+      milliseconds;
+  operation_timings.next_recent =
+      (operation_timings.next_recent + 1) % kRecentCount;
+}
+
+std::vector<TimingSummary> GetTimingSummaries() {
+  std::vector<TimingSummary> summaries;
+
+  std::lock_guard lock(timings_mutex);
+  for (size_t i = 0; i < kTimedOperationCount; i++) {
+    const OperationTimings& operation_timings = timings[i];
+
+    TimingSummary summary;
+    summary.operation = static_cast<TimedOperation>(i);
+    summary.count = operation_timings.count;
+
+    if (operation_timings.count > 0) {
+      summary.mean_milliseconds =
+          operation_timings.total_milliseconds / operation_timings.count;
+      summary.max_milliseconds = operation_timings.max_milliseconds;
+
+      size_t recent_count = std::min(operation_timings.count, kRecentCount);
+      size_t oldest =
+          operation_timings.next_recent + kRecentCount - recent_count;
+      for (size_t j = 0; j < recent_count; j++) {
+        summary.recent_milliseconds.push_back(
+            operation_timings.recent_milliseconds[(oldest + j) % kRecentCount]);
+      }
+
+      summary.last_milliseconds = summary.recent_milliseconds.back();
+    }
+
+    summaries.push_back(std::move(summary));
+  }
+
+  return summaries;
+}
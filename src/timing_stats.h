@@ -0,0 +1,57 @@
+#ifndef TIMING_STATS_H_3A7D5C10
+#define TIMING_STATS_H_3A7D5C10
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+// Always-on timings of the operations that the diagnostics panel shows.
+// Unlike trace spans, these are kept in every build, so only coarse
+// operations should be timed.
+enum class TimedOperation {
+  kCatalogLoad,
+  kWorldLoad,
+  kWorldParse,
+  kFileSave,
+  kFormRebuild,
+  kFilterQuery,
+};
+
+constexpr size_t kTimedOperationCount = 6;
+
+const char* GetTimedOperationName(TimedOperation operation);
+
+struct TimingSummary {
+  TimedOperation operation;
+  size_t count = 0;
+  double last_milliseconds = 0;
+  double mean_milliseconds = 0;
+  double max_milliseconds = 0;
+  std::vector<double> recent_milliseconds;  // oldest first
+};
+
+// Safe to call from any thread.
+void RecordTiming(TimedOperation operation,
+                  std::chrono::steady_clock::duration duration);
+
+// One summary per operation, in the order of TimedOperation.
+std::vector<TimingSummary> GetTimingSummaries();
+
+class ScopedTiming {
+ public:
+  explicit ScopedTiming(TimedOperation operation)
+      : operation_(operation), start_(std::chrono::steady_clock::now()) {}
+
+  ScopedTiming(const ScopedTiming&) = delete;
+  ScopedTiming& operator=(const ScopedTiming&) = delete;
+
+  ~ScopedTiming() {
+    RecordTiming(operation_, std::chrono::steady_clock::now() - start_);
+  }
+
+ private:
+  TimedOperation operation_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+#endif /* end of include guard: TIMING_STATS_H_3A7D5C10 */
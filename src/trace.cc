@@ -0,0 +1,191 @@
+#include "trace.h"
+
+#ifdef AP_WIZARD_TRACE
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace trace_internal {
+namespace {
+
+struct Span {
+  const char* name;
+  int64_t start;
+  int64_t end;
+  char detail[kMaxDetailSize];
+  size_t detail_size;
+  TraceArg args[kMaxArgs];
+  size_t arg_count;
+};
+
+// Only the owning thread appends to a chunk, and it publishes each span by
+// bumping the chunk's size, so the trace can be written while other threads
+// are still running.
+struct Chunk {
+  static constexpr size_t kCapacity = 256;
+
+  std::array<Span, kCapacity> spans;
+  std::atomic<size_t> size = 0;
+  std::atomic<Chunk*> next = nullptr;
+};
+
+struct ThreadBuffer {
+  explicit ThreadBuffer(int thread_id) : thread_id(thread_id) {}
+
+  int thread_id;
+  Chunk head;
+  Chunk* tail = &head;  // only used by the owning thread
+};
+
+int64_t Now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// The buffers are never freed, as threads may still be recording into them
+// while the program exits.
+class Tracer {
+ public:
+  Tracer() {
+    if (const char* filename = std::getenv("AP_WIZARD_TRACE")) {
+      filename_ = filename;
+    }
+
+    epoch_ = Now();
+  }
+
+  bool IsEnabled() const { return !filename_.empty(); }
+
+  ThreadBuffer* AddThread() {
+    std::lock_guard lock(mutex_);
+
+    buffers_.push_back(new ThreadBuffer(buffers_.size() + 1));
+    return buffers_.back();
+  }
+
+  void Write() const {
+    nlohmann::json events = nlohmann::json::array();
+    events.push_back({{"name", "process_name"},
+                      {"ph", "M"},
+                      {"pid", 1},
+                      {"args", {{"name", "ap_wizard"}}}});
+
+    std::lock_guard lock(mutex_);
+    for (const ThreadBuffer* buffer : buffers_) {
+      for (const Chunk* chunk = &buffer->head; chunk != nullptr;
+           chunk = chunk->next.load(std::memory_order_acquire)) {
+        size_t size = chunk->size.load(std::memory_order_acquire);
+        for (size_t i = 0; i < size; i++) {
+          const Span& span = chunk->spans[i];
+
+          // Chrome expects microseconds.
+          nlohmann::json event = {{"name", span.name},
+                                  {"cat", "ap_wizard"},
+                                  {"ph", "X"},
+                                  {"ts", (span.start - epoch_) / 1000.0},
+                                  {"dur", (span.end - span.start) / 1000.0},
+                                  {"pid", 1},
+                                  {"tid", buffer->thread_id}};
+
+          if (span.detail_size > 0) {
+            event["args"]["detail"] =
+                std::string(span.detail, span.detail_size);
+          }
+
+          for (size_t j = 0; j < span.arg_count; j++) {
+            event["args"][span.args[j].name] = span.args[j].value;
+          }
+
+          events.push_back(std::move(event));
+        }
+      }
+    }
+
+    std::ofstream file(filename_);
+    // Details cut short may end part-way through a UTF-8 sequence.
+    file << nlohmann::json{{"traceEvents", std::move(events)},
+                           {"displayTimeUnit", "ms"}}
+                .dump(-1, ' ', false,
+                      nlohmann::json::error_handler_t::replace)
+         << std::endl;
+
+    if (!file) {
+      std::cerr << "Could not write trace to \"" << filename_ << "\"."
+                << std::endl;
+    }
+  }
+
+ private:
+  std::string filename_;
+  int64_t epoch_;
+
+  mutable std::mutex mutex_;
+  std::vector<ThreadBuffer*> buffers_;
+};
+
+Tracer& GetTracer() {
+  static Tracer* tracer = [] {
+    Tracer* result = new Tracer();
+    if (result->IsEnabled()) {
+      std::atexit([] { GetTracer().Write(); });
+    }
+
+    return result;
+  }();
+
+  return *tracer;
+}
+
+}  // namespace
+
+bool IsEnabled() {
+  static const bool enabled = GetTracer().IsEnabled();
+  return enabled;
+}
+
+int64_t GetTimestamp() { return Now(); }
+
+void RecordSpan(const char* name, std::string_view detail, int64_t start,
+                int64_t end, std::initializer_list<TraceArg> args) {
+  thread_local ThreadBuffer* buffer = GetTracer().AddThread();
+
+  Chunk* chunk = buffer->tail;
+  size_t size = chunk->size.load(std::memory_order_relaxed);
+  if (size == Chunk::kCapacity) {
+    Chunk* next = new Chunk();
+    chunk->next.store(next, std::memory_order_release);
+
+    buffer->tail = chunk = next;
+    size = 0;
+  }
+
+  Span& span = chunk->spans[size];
+  span.name = name;
+  span.start = start;
+  span.end = end;
+  span.detail_size = detail.copy(span.detail, kMaxDetailSize);
+
+  span.arg_count = 0;
+  for (const TraceArg& arg : args) {
+    if (span.arg_count == kMaxArgs) {
+      break;
+    }
+
+    span.args[span.arg_count++] = arg;
+  }
+
+  chunk->size.store(size + 1, std::memory_order_release);
+}
+
+}  // namespace trace_internal
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef TRACE_H_6B1F3E92
+#define TRACE_H_6B1F3E92
+
+// Scoped spans for the Chrome trace viewer (chrome://tracing, or Perfetto).
+// They are only compiled in when the build defines AP_WIZARD_TRACE, and only
+// recorded when the AP_WIZARD_TRACE environment variable names a file, which
+// the trace is written to when the program exits.
+//
+//   void World::Save(const std::string& filename) {
+//     TRACE_SPAN("World::Save", filename);
+//     ...
+//   }
+//
+// The name must be a string literal. The optional detail, such as a game or
+// file name, is copied, and is not evaluated when tracing is compiled out.
+// Each thread records into its own buffer, so recording never takes a lock.
+
+#ifdef AP_WIZARD_TRACE
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+
+namespace trace_internal {
+
+// Longer details are cut short, so that recording a span never allocates.
+constexpr size_t kMaxDetailSize = 64;
+
+// A number shown alongside a span, such as how many allocations it made.
+struct TraceArg {
+  const char* name;  // a string literal
+  int64_t value;
+};
+
+// Further arguments are dropped.
+constexpr size_t kMaxArgs = 2;
+
+bool IsEnabled();
+
+int64_t GetTimestamp();
+
+void RecordSpan(const char* name, std::string_view detail, int64_t start,
+                int64_t end, std::initializer_list<TraceArg> args = {});
+
+}  // namespace trace_internal
+
+class TraceSpan {
+ public:
+  explicit TraceSpan(const char* name, std::string_view detail = {})
+      : name_(name) {
+    if (trace_internal::IsEnabled()) {
+      detail_size_ = detail.copy(detail_, trace_internal::kMaxDetailSize);
+      start_ = trace_internal::GetTimestamp();
+    }
+  }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  ~TraceSpan() {
+    if (start_ >= 0) {
+      trace_internal::RecordSpan(name_, {detail_, detail_size_}, start_,
+                                 trace_internal::GetTimestamp());
+    }
+  }
+
+ private:
+  const char* name_;
+  char detail_[trace_internal::kMaxDetailSize];
+  size_t detail_size_ = 0;
+  int64_t start_ = -1;
+};
+
+#define TRACE_SPAN_CONCAT_INNER(a, b) a##b
+#define TRACE_SPAN_CONCAT(a, b) TRACE_SPAN_CONCAT_INNER(a, b)
+#define TRACE_SPAN(...) \
+  TraceSpan TRACE_SPAN_CONCAT(trace_span_, __LINE__)(__VA_ARGS__)
+
+#else
+
+#define TRACE_SPAN(...) ((void)0)
+
+#endif
+
+#endif /* end of include guard: TRACE_H_6B1F3E92 */
@@ -1,179 +1,45 @@
 #include "util.h"
 
-#include <whereami.h>
-
-#include <sstream>
 #include <vector>
 
-OptionValue GetRandomOptionValueFromString(wxString descriptor) {
-  OptionValue result;
-
-  auto parts = split<std::vector<wxString>>(descriptor, "-");
-  int it = 0;
-
-  if (parts[it] == "random") {
-    result.random = true;
-    result.range_random_type = kUniformRandom;
-
-    it++;
-  }
-
-  if (it == parts.size()) {
-    return result;
-  }
-
-  bool is_range = false;
-  if (parts[it] == "range") {
-    is_range = true;
-
-    it++;
-
-    // It's an error for there to be no parts after "range".
-    if (it == parts.size()) {
-      wxString error;
-      error << "Ranged random specifier \"";
-      error << descriptor;
-      error << "\" missing min and max values.";
-
-      result.error = error.ToStdString();
-      return result;
-    }
-  }
-
-  if (parts[it] == "low" || parts[it] == "middle" || parts[it] == "high") {
-    if (parts[it] == "low") {
-      result.range_random_type = kLowRandom;
-    } else if (parts[it] == "middle") {
-      result.range_random_type = kMiddleRandom;
-    } else if (parts[it] == "high") {
-      result.range_random_type = kHighRandom;
-    }
-
-    it++;
-  }
-
-  if (is_range) {
-    if (it == parts.size()) {
-      wxString error;
-      error << "Ranged random specifier \"";
-      error << descriptor;
-      error << "\" missing min and max values.";
-
-      result.error = error.ToStdString();
-      return result;
-    }
-
-    if (it + 1 == parts.size()) {
-      wxString error;
-      error << "Ranged random specifier \"";
-      error << descriptor;
-      error << "\" missing max value.";
-
-      result.error = error.ToStdString();
-      return result;
-    }
-
-    long min = 0;
-    if (!parts[it].ToLong(&min)) {
-      wxString error;
-      error << "Ranged random specifier \"";
-      error << descriptor;
-      error << "\" min value is not numeric.";
-
-      result.error = error.ToStdString();
-      return result;
-    }
-
-    long max = 0;
-    if (!parts[it + 1].ToLong(&max)) {
-      wxString error;
-      error << "Ranged random specifier \"";
-      error << descriptor;
-      error << "\" max value is not numeric.";
-
-      result.error = error.ToStdString();
-      return result;
-    }
-
-    result.range_subset = std::tuple<int, int>(min, max);
-
-    it++;
-    it++;
-  }
-
-  if (it != parts.size()) {
-    wxString error;
-    error << "Malformed random specifier \"";
-    error << descriptor;
-    error << "\".";
-
-    result.error = error.ToStdString();
+wxString ConvertToTitleCase(wxString input) {
+  auto words = split<std::vector<wxString>>(input, " ");
+  for (wxString& word : words) {
+    word.MakeCapitalized();
   }
 
-  return result;
+  return implode(words, " ");
 }
 
-std::string RandomOptionValueToString(const OptionValue& option_value) {
-  std::ostringstream random_str;
-  random_str << "random";
+wxString FormatBulkImportReport(const BulkImportResult& result) {
+  constexpr size_t kMaxReportedEntries = 20;
 
-  if (option_value.range_subset) {
-    random_str << "-range";
-  }
+  wxString report;
+  report << "Imported " << result.entries.size() << " value(s). ";
+  report << result.unknown.size() << " value(s) were not recognised:\n";
 
-  if (option_value.range_random_type == kLowRandom) {
-    random_str << "-low";
-  } else if (option_value.range_random_type == kMiddleRandom) {
-    random_str << "-middle";
-  } else if (option_value.range_random_type == kHighRandom) {
-    random_str << "-high";
-  }
+  for (size_t i = 0; i < result.unknown.size() && i < kMaxReportedEntries;
+       i++) {
+    const UnknownImportEntry& unknown = result.unknown[i];
 
-  if (option_value.range_subset) {
-    auto& [min, max] = *option_value.range_subset;
-    random_str << "-" << min << "-" << max;
-  }
-
-  return random_str.str();
-}
+    report << "\nLine " << unknown.line << ": \"";
+    report << wxString::FromUTF8(unknown.name) << "\"";
 
-const DoubleMap<std::string>& GetOptionSetElements(
-    const Game& game, const std::string& option_name) {
-  const OptionDefinition& game_option = game.GetOption(option_name);
+    if (!unknown.suggestions.empty()) {
+      std::vector<wxString> suggestions;
+      for (const std::string& suggestion : unknown.suggestions) {
+        suggestions.push_back(wxString::FromUTF8(suggestion));
+      }
 
-  if (game_option.set_type == kCustomSet) {
-    return game_option.custom_set;
-  } else if (game_option.set_type == kItemSet) {
-    return game.GetItems();
-  } else if (game_option.set_type == kLocationSet) {
-    return game.GetLocations();
+      report << " (did you mean \"" << implode(suggestions, "\", \"")
+             << "\"?)";
+    }
   }
 
-  throw std::invalid_argument("Invalid option set type.");
-}
-
-const std::filesystem::path& GetExecutableDirectory() {
-  static const std::filesystem::path* executable_directory = []() {
-    int length = wai_getExecutablePath(NULL, 0, NULL);
-    std::string buf(length, 0);
-    wai_getExecutablePath(buf.data(), length, NULL);
-
-    std::filesystem::path exec_path(buf);
-    return new std::filesystem::path(exec_path.parent_path());
-  }();
-
-  return *executable_directory;
-}
-
-std::string GetAbsolutePath(std::string_view path) {
-  return (GetExecutableDirectory() / path).string();
-}
-
-wxString ConvertToTitleCase(wxString input) {
-  auto words = split<std::vector<wxString>>(input, " ");
-  for (wxString& word : words) {
-    word.MakeCapitalized();
+  if (result.unknown.size() > kMaxReportedEntries) {
+    report << "\n\n...and " << (result.unknown.size() - kMaxReportedEntries)
+           << " more.";
   }
 
-  return implode(words, " ");
+  return report;
 }
@@ -9,13 +9,10 @@
 
 #include <wx/textfile.h>
 
-#include <filesystem>
 #include <iterator>
-#include <string>
-#include <string_view>
 
-#include "double_map.h"
-#include "game_definition.h"
+#include "bulk_import.h"
+#include "core_util.h"
 
 template <class InputIterator>
 wxString implode(InputIterator first, InputIterator last, wxString delimiter) {
@@ -69,17 +66,8 @@ Container split(wxString input, wxString delimiter) {
   return result;
 }
 
-OptionValue GetRandomOptionValueFromString(wxString descriptor);
-
-std::string RandomOptionValueToString(const OptionValue& option_value);
-
-const DoubleMap<std::string>& GetOptionSetElements(
-    const Game& game, const std::string& option_name);
-
-const std::filesystem::path& GetExecutableDirectory();
-
-std::string GetAbsolutePath(std::string_view path);
-
 wxString ConvertToTitleCase(wxString input);
 
+wxString FormatBulkImportReport(const BulkImportResult& result);
+
 #endif /* end of include guard: UTIL_H_84145E76 */
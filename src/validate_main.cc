@@ -0,0 +1,294 @@
+// ap_wizard_validate: checks player YAMLs against the dumped option data
+// without opening any windows, and writes a JSON report.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "diagnostic.h"
+#include "game_definition.h"
+#include "parallel.h"
+#include "world.h"
+
+namespace {
+
+constexpr const char* kUsage =
+    "Usage: ap_wizard_validate [options] PATH...\n"
+    "\n"
+    "Validates each YAML file, and each .yaml or .yml file in each folder,\n"
+    "and writes a JSON report.\n"
+    "\n"
+    "Options:\n"
+    "  --definitions FILE  the dumped-options.json to validate against\n"
+    "                      (default: the one next to this executable)\n"
+    "  --output FILE       where to write the report (default: stdout)\n"
+    "  --threads N         how many files to validate at once\n"
+    "                      (default: one per core)\n";
+
+// Exit codes.
+constexpr int kAllValid = 0;
+constexpr int kSomeInvalid = 1;
+constexpr int kUsageError = 2;
+
+struct FileResult {
+  nlohmann::ordered_json report;
+  bool valid = true;
+  std::chrono::duration<double> time{};
+};
+
+// The first line is where the world starts in its file.
+nlohmann::ordered_json DiagnosticToJson(const Diagnostic& diagnostic,
+                                        int first_line) {
+  nlohmann::ordered_json result;
+  result["message"] = FormatDiagnostic(diagnostic);
+
+  // Positions are one-indexed, as an editor would show them.
+  if (diagnostic.line >= 0) {
+    result["line"] = first_line + diagnostic.line + 1;
+    result["column"] = diagnostic.column + 1;
+  }
+
+  return result;
+}
+
+// Returns whether the world is valid.
+bool ValidateWorld(World& world, nlohmann::ordered_json& report) {
+  bool valid = true;
+  nlohmann::ordered_json errors = nlohmann::ordered_json::array();
+
+  try {
+    world.EnsureLoaded();
+  } catch (const std::exception& ex) {
+    errors.push_back(ex.what());
+    report["errors"] = std::move(errors);
+
+    return false;
+  }
+
+  report["name"] = world.GetName();
+
+  if (world.HasGame()) {
+    report["game"] = world.GetGame();
+  } else {
+    errors.push_back("No game is set.");
+    valid = false;
+  }
+
+  nlohmann::ordered_json options = nlohmann::ordered_json::array();
+  for (const std::string& option_name : world.GetInvalidOptions()) {
+    nlohmann::ordered_json option_report;
+    option_report["option"] = option_name;
+
+    nlohmann::ordered_json option_errors = nlohmann::ordered_json::array();
+    for (const Diagnostic& diagnostic : world.GetOptionErrors(option_name)) {
+      option_errors.push_back(
+          DiagnosticToJson(diagnostic, world.GetFirstLine()));
+    }
+    option_report["errors"] = std::move(option_errors);
+
+    options.push_back(std::move(option_report));
+    valid = false;
+  }
+
+  report["errors"] = std::move(errors);
+  report["options"] = std::move(options);
+
+  // Unknown options are ignored by the generator, so they are only reported.
+  report["unknown_options"] = world.GetUnknownOptions();
+
+  return valid;
+}
+
+FileResult ValidateFile(const GameDefinitions& game_definitions,
+                        const std::string& filename) {
+  auto start = std::chrono::steady_clock::now();
+
+  FileResult result;
+  result.report["file"] = filename;
+
+  try {
+    std::vector<std::unique_ptr<World>> worlds =
+        World::LoadAll(&game_definitions, filename);
+
+    nlohmann::ordered_json worlds_report = nlohmann::ordered_json::array();
+    for (const std::unique_ptr<World>& world : worlds) {
+      nlohmann::ordered_json world_report;
+      if (std::optional<size_t> index = world->GetDocumentIndex()) {
+        world_report["document"] = *index + 1;
+      }
+
+      if (!ValidateWorld(*world, world_report)) {
+        result.valid = false;
+      }
+
+      worlds_report.push_back(std::move(world_report));
+    }
+
+    result.report["valid"] = result.valid;
+    result.report["worlds"] = std::move(worlds_report);
+  } catch (const std::exception& ex) {
+    result.valid = false;
+    result.report["valid"] = false;
+    result.report["error"] = ex.what();
+  }
+
+  result.time = std::chrono::steady_clock::now() - start;
+  result.report["milliseconds"] = result.time.count() * 1000;
+
+  return result;
+}
+
+// Expands folders into the YAML files directly inside them, in order.
+std::vector<std::string> CollectFiles(const std::vector<std::string>& paths) {
+  std::vector<std::string> filenames;
+
+  for (const std::string& path : paths) {
+    if (!std::filesystem::is_directory(path)) {
+      filenames.push_back(path);
+      continue;
+    }
+
+    std::vector<std::string> folder_filenames;
+    for (const std::filesystem::directory_entry& entry :
+         std::filesystem::directory_iterator(path)) {
+      std::string extension = entry.path().extension().string();
+      if (entry.is_regular_file() &&
+          (extension == ".yaml" || extension == ".yml")) {
+        folder_filenames.push_back(entry.path().string());
+      }
+    }
+
+    std::sort(folder_filenames.begin(), folder_filenames.end());
+    filenames.insert(filenames.end(), folder_filenames.begin(),
+                     folder_filenames.end());
+  }
+
+  return filenames;
+}
+
+// The nearest-rank percentile of sorted values, in milliseconds.
+double GetPercentile(const std::vector<double>& sorted_seconds,
+                     double percentile) {
+  if (sorted_seconds.empty()) {
+    return 0;
+  }
+
+  size_t rank = static_cast<size_t>(
+      std::ceil(percentile / 100 * sorted_seconds.size()));
+
+  return sorted_seconds[std::max<size_t>(rank, 1) - 1] * 1000;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string definitions_filename;
+  std::string output_filename;
+  size_t thread_count = 0;
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+
+    if (arg == "--help" || arg == "-h") {
+      std::cout << kUsage;
+      return kAllValid;
+    } else if (arg == "--definitions" && i + 1 < argc) {
+      definitions_filename = argv[++i];
+    } else if (arg == "--output" && i + 1 < argc) {
+      output_filename = argv[++i];
+    } else if (arg == "--threads" && i + 1 < argc) {
+      thread_count = std::strtoul(argv[++i], nullptr, 10);
+    } else if (arg.starts_with("--")) {
+      std::cerr << kUsage;
+      return kUsageError;
+    } else {
+      paths.emplace_back(arg);
+    }
+  }
+
+  if (paths.empty()) {
+    std::cerr << kUsage;
+    return kUsageError;
+  }
+
+  std::unique_ptr<GameDefinitions> game_definitions;
+  std::vector<std::string> filenames;
+  try {
+    game_definitions =
+        definitions_filename.empty()
+            ? std::make_unique<GameDefinitions>()
+            : std::make_unique<GameDefinitions>(definitions_filename);
+
+    filenames = CollectFiles(paths);
+  } catch (const std::exception& ex) {
+    std::cerr << ex.what() << std::endl;
+    return kUsageError;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  std::vector<FileResult> results(filenames.size());
+  ParallelFor(
+      filenames.size(),
+      [&](size_t i) {
+        results[i] = ValidateFile(*game_definitions, filenames[i]);
+      },
+      thread_count);
+
+  std::chrono::duration<double> total_time =
+      std::chrono::steady_clock::now() - start;
+
+  nlohmann::ordered_json files_report = nlohmann::ordered_json::array();
+  std::vector<double> file_seconds;
+  size_t valid_count = 0;
+
+  for (FileResult& result : results) {
+    if (result.valid) {
+      valid_count++;
+    }
+
+    file_seconds.push_back(result.time.count());
+    files_report.push_back(std::move(result.report));
+  }
+
+  std::sort(file_seconds.begin(), file_seconds.end());
+
+  nlohmann::ordered_json summary;
+  summary["files"] = filenames.size();
+  summary["valid"] = valid_count;
+  summary["invalid"] = filenames.size() - valid_count;
+  summary["seconds"] = total_time.count();
+  summary["files_per_second"] =
+      total_time.count() > 0 ? filenames.size() / total_time.count() : 0;
+  summary["p50_milliseconds"] = GetPercentile(file_seconds, 50);
+  summary["p99_milliseconds"] = GetPercentile(file_seconds, 99);
+
+  nlohmann::ordered_json report;
+  report["summary"] = std::move(summary);
+  report["files"] = std::move(files_report);
+
+  if (output_filename.empty()) {
+    std::cout << report.dump(2) << std::endl;
+  } else {
+    std::ofstream output(output_filename);
+    output << report.dump(2) << std::endl;
+
+    if (!output) {
+      std::cerr << "Could not write \"" << output_filename << "\"."
+                << std::endl;
+      return kUsageError;
+    }
+  }
+
+  return valid_count == filenames.size() ? kAllValid : kSomeInvalid;
+}
@@ -2,6 +2,7 @@
 #define WINDOW_POOL_H_E46A8EBB
 
 #include <stack>
+#include <string>
 #include <vector>
 
 #include <wx/wxprec.h>
@@ -10,6 +11,12 @@
 #include <wx/wx.h>
 #endif
 
+struct WindowPoolStats {
+  std::string name;
+  size_t pooled = 0;  // created, but hidden until they're needed again
+  size_t used = 0;
+};
+
 template <typename T>
 class WindowPool {
  public:
@@ -40,6 +47,10 @@ class WindowPool {
     used_.clear();
   }
 
+  WindowPoolStats GetStats(std::string name) const {
+    return {std::move(name), pool_.size(), used_.size()};
+  }
+
  private:
   wxWindow* parent_;
   std::stack<T*> pool_;
@@ -1,8 +1,10 @@
 #include "wizard_editor.h"
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <optional>
+#include <stdexcept>
 
 #include <wx/checklst.h>
 #include <wx/collpane.h>
@@ -14,6 +16,9 @@
 #include "option_set_dialog.h"
 #include "random_choice_dialog.h"
 #include "random_range_dialog.h"
+#include "session_script.h"
+#include "timing_stats.h"
+#include "trace.h"
 #include "util.h"
 #include "window_pool.h"
 #include "world.h"
@@ -24,6 +29,16 @@ enum WizardEditorIds { ID_CONNECT = 1, ID_CHECK_FOR_UPDATES = 2 };
 
 constexpr int kMaxChoicesInChecklist = 15;
 
+void RecordDialogStep(SessionStepType type,
+                      const std::string& option_name = "") {
+  if (IsRecordingSession()) {
+    SessionStep step;
+    step.type = type;
+    step.option = option_name;
+    RecordSessionStep(step);
+  }
+}
+
 class WizardEditorImpl;
 
 struct EditorPoolManager {
@@ -53,6 +68,16 @@ struct EditorPoolManager {
     toggle_buttons_.Reset();
     buttons_.Reset();
   }
+
+  void AddStats(const std::string& section,
+                std::vector<WindowPoolStats>& stats) const {
+    stats.push_back(labels_.GetStats(section + ": labels"));
+    stats.push_back(choices_.GetStats(section + ": choices"));
+    stats.push_back(pickers_.GetStats(section + ": numeric pickers"));
+    stats.push_back(check_lists_.GetStats(section + ": check lists"));
+    stats.push_back(toggle_buttons_.GetStats(section + ": toggle buttons"));
+    stats.push_back(buttons_.GetStats(section + ": buttons"));
+  }
 };
 
 class FormOption {
@@ -64,6 +89,12 @@ class FormOption {
 
   void PopulateFromWorld();
 
+  const std::string& GetOptionName() const { return option_name_; }
+
+  // Sets the value through the controls if they can show it, and otherwise
+  // the way the dialogs do.
+  void ReplayValue(std::optional<OptionValue> option_value);
+
  private:
   friend class WizardEditor;
 
@@ -78,6 +109,9 @@ class FormOption {
 
   void SaveToWorld();
 
+  // Records the option's new value, if the session is being recorded.
+  void RecordValue();
+
   WizardEditorImpl* parent_;
 
   std::string option_name_;
@@ -102,6 +136,15 @@ class WizardEditorImpl : public WizardEditor {
     message_callback_ = std::move(callback);
   }
 
+  std::vector<WindowPoolStats> GetWindowPoolStats() const override;
+
+  void ReplaySetGame(const std::string& game) override;
+
+  void ReplayApplyPreset(const std::string& preset) override;
+
+  void ReplaySetOption(const std::string& option_name,
+                       std::optional<OptionValue> option_value) override;
+
  private:
   friend class FormOption;
 
@@ -116,6 +159,10 @@ class WizardEditorImpl : public WizardEditor {
   void OnChangeGame(wxCommandEvent& event);
   void OnChangePreset(wxCommandEvent& event);
 
+  // What the handlers do once the change has been confirmed.
+  void ChangeGame();
+  void ApplyPreset();
+
   const GameDefinitions* game_definitions_;
 
   World* world_ = nullptr;
@@ -225,7 +272,19 @@ void WizardEditorImpl::LoadWorld(World* world) {
 
 void WizardEditorImpl::Reload() { Rebuild(); }
 
+std::vector<WindowPoolStats> WizardEditorImpl::GetWindowPoolStats() const {
+  std::vector<WindowPoolStats> stats;
+  other_options_manager_->AddStats("Options", stats);
+  common_options_manager_->AddStats("Common options", stats);
+  hidden_options_manager_->AddStats("Hidden options", stats);
+
+  return stats;
+}
+
 void WizardEditorImpl::Rebuild() {
+  TRACE_SPAN("WizardEditorImpl::Rebuild");
+  ScopedTiming timing(TimedOperation::kFormRebuild);
+
   std::optional<std::string> next_game;
   if (world_ && world_->HasGame()) {
     next_game = world_->GetGame();
@@ -324,6 +383,8 @@ void WizardEditorImpl::Rebuild() {
 }
 
 void WizardEditorImpl::Populate() {
+  TRACE_SPAN("WizardEditorImpl::Populate");
+
   if (world_) {
     name_box_->ChangeValue(world_->GetName());
     description_box_->ChangeValue(world_->GetDescription());
@@ -344,6 +405,8 @@ void WizardEditorImpl::Populate() {
 }
 
 void WizardEditorImpl::FixSize() {
+  TRACE_SPAN("WizardEditorImpl::FixSize");
+
   SetSizer(top_sizer_);
   Layout();
   FitInside();
@@ -372,6 +435,10 @@ void WizardEditorImpl::OnChangeGame(wxCommandEvent& event) {
     }
   }
 
+  ChangeGame();
+}
+
+void WizardEditorImpl::ChangeGame() {
   if (game_box_->GetSelection() == 0) {
     world_->UnsetGame();
   } else {
@@ -379,6 +446,15 @@ void WizardEditorImpl::OnChangeGame(wxCommandEvent& event) {
         game_box_->GetString(game_box_->GetSelection()).ToStdString());
   }
 
+  if (IsRecordingSession()) {
+    SessionStep step;
+    step.type = SessionStepType::kSetGame;
+    if (world_->HasGame()) {
+      step.game = world_->GetGame();
+    }
+    RecordSessionStep(step);
+  }
+
   Rebuild();
 }
 
@@ -396,20 +472,62 @@ void WizardEditorImpl::OnChangePreset(wxCommandEvent& event) {
     }
   }
 
-  world_->ClearOptions();
+  ApplyPreset();
+}
 
+void WizardEditorImpl::ApplyPreset() {
   const Game& game = game_definitions_->GetGame(world_->GetGame());
-  const std::map<std::string, OptionValue>& preset = game.GetPresets().at(
-      preset_box_->GetString(preset_box_->GetSelection()).ToStdString());
-
-  for (const auto& [option_name, option_value] : preset) {
-    world_->SetOption(option_name, option_value);
+  std::string preset_name =
+      preset_box_->GetString(preset_box_->GetSelection()).ToStdString();
+  world_->ApplyOptions(game.GetPresets().at(preset_name));
+
+  if (IsRecordingSession()) {
+    SessionStep step;
+    step.type = SessionStepType::kApplyPreset;
+    step.preset = preset_name;
+    RecordSessionStep(step);
   }
 
   Populate();
   Layout();
 }
 
+void WizardEditorImpl::ReplaySetGame(const std::string& game) {
+  int selection =
+      game.empty() ? 0 : game_box_->FindString(game, /*bCase=*/true);
+  if (selection == wxNOT_FOUND) {
+    throw std::runtime_error("There is no game \"" + game + "\".");
+  }
+
+  game_box_->SetSelection(selection);
+  ChangeGame();
+}
+
+void WizardEditorImpl::ReplayApplyPreset(const std::string& preset) {
+  int selection = preset_box_->FindString(preset, /*bCase=*/true);
+  if (preset.empty() || !preset_box_->IsShown() || selection == wxNOT_FOUND) {
+    throw std::runtime_error("There is no preset \"" + preset + "\".");
+  }
+
+  preset_box_->SetSelection(selection);
+  ApplyPreset();
+}
+
+void WizardEditorImpl::ReplaySetOption(
+    const std::string& option_name, std::optional<OptionValue> option_value) {
+  auto form_option = std::find_if(
+      form_options_.begin(), form_options_.end(),
+      [&option_name](const FormOption& form_option) {
+        return form_option.GetOptionName() == option_name;
+      });
+  if (form_option == form_options_.end()) {
+    throw std::runtime_error("The form has no option \"" + option_name +
+                             "\".");
+  }
+
+  form_option->ReplayValue(std::move(option_value));
+}
+
 FormOption::FormOption(WizardEditorImpl* parent, EditorPoolManager& container,
                        const std::string& option_name, wxSizer* sizer)
     : parent_(parent), option_name_(option_name) {
@@ -440,7 +558,7 @@ FormOption::FormOption(WizardEditorImpl* parent, EditorPoolManager& container,
     numeric_picker_ = container.pickers_.Allocate();
     numeric_picker_->SetMin(game_option.min_value);
     numeric_picker_->SetMax(game_option.max_value);
-    numeric_picker_->SetValue(game_option.default_value.int_value);
+    numeric_picker_->ChangeValue(game_option.default_value.int_value);
     numeric_picker_->Bind(EVT_PICK_NUMBER, &FormOption::OnRangePickerChanged,
                           this);
 
@@ -562,7 +680,7 @@ void FormOption::PopulateFromWorld() {
                               ? parent_->world_->GetOption(option_name_)
                               : game_option.default_value;
 
-  if (ov.error) {
+  if (!ov.errors.empty()) {
     option_label_->SetForegroundColour(*wxRED);
   } else {
     option_label_->SetForegroundColour(
@@ -570,7 +688,7 @@ void FormOption::PopulateFromWorld() {
   }
 
   if (game_option.type == kSelectOption) {
-    if (ov.error) {
+    if (!ov.errors.empty()) {
       combo_box_->Disable();
       random_button_->Disable();
       random_button_->SetValue(false);
@@ -587,7 +705,7 @@ void FormOption::PopulateFromWorld() {
       combo_box_->Enable();
     }
   } else if (game_option.type == kRangeOption) {
-    if (ov.error) {
+    if (!ov.errors.empty()) {
       numeric_picker_->Disable();
       random_button_->Disable();
       random_button_->SetValue(false);
@@ -605,7 +723,7 @@ void FormOption::PopulateFromWorld() {
       }
     } else {
       numeric_picker_->Enable();
-      numeric_picker_->SetValue(ov.int_value);
+      numeric_picker_->ChangeValue(ov.int_value);
       random_button_->Enable();
       random_button_->SetValue(false);
 
@@ -622,17 +740,17 @@ void FormOption::PopulateFromWorld() {
   } else if (game_option.type == kSetOption ||
              game_option.type == kDictOption) {
     if (list_box_ != nullptr) {
-      if (ov.error) {
+      if (!ov.errors.empty()) {
         list_box_->Disable();
       } else {
         list_box_->Enable();
 
-        for (int i = 0; i < ov.set_values.size(); i++) {
-          list_box_->Check(i, ov.set_values.at(i));
+        for (size_t i = 0; i < ov.set_values->size(); i++) {
+          list_box_->Check(i, ov.set_values->at(i));
         }
       }
     } else if (open_choice_btn_ != nullptr) {
-      if (ov.error) {
+      if (!ov.errors.empty()) {
         open_choice_btn_->Disable();
       } else {
         open_choice_btn_->Enable();
@@ -648,9 +766,10 @@ void FormOption::OnHoverLabel(wxMouseEvent& event) {
 
   if (parent_->message_callback_) {
     if (parent_->world_->HasOption(game_option.name) &&
-        parent_->world_->GetOption(game_option.name).error) {
+        !parent_->world_->GetOptionErrors(game_option.name).empty()) {
       parent_->message_callback_(
-          "Error", *parent_->world_->GetOption(game_option.name).error);
+          "Error", FormatDiagnostics(
+                       parent_->world_->GetOptionErrors(game_option.name)));
     } else {
       parent_->message_callback_(game_option.display_name,
                                  game_option.description);
@@ -696,7 +815,7 @@ void FormOption::OnNamedRangeChanged(wxCommandEvent& event) {
     int result = game_option.value_names.GetKeyById(combo_box_->GetSelection());
 
     if (result != numeric_picker_->GetValue()) {
-      numeric_picker_->SetValue(result);
+      numeric_picker_->ChangeValue(result);
 
       SaveToWorld();
     }
@@ -720,7 +839,10 @@ void FormOption::OnRandomClicked(wxCommandEvent& event) {
 
   if (game_option.type == kSelectOption) {
     RandomChoiceDialog rcd(&game_option, option_value);
-    if (rcd.ShowModal() != wxID_OK) {
+    RecordDialogStep(SessionStepType::kOpenDialog, option_name_);
+    int result = rcd.ShowModal();
+    RecordDialogStep(SessionStepType::kCloseDialog);
+    if (result != wxID_OK) {
       return;
     }
 
@@ -748,7 +870,10 @@ void FormOption::OnRandomClicked(wxCommandEvent& event) {
     }
   } else if (game_option.type == kRangeOption) {
     RandomRangeDialog rrd(&game_option, option_value);
-    if (rrd.ShowModal() != wxID_OK) {
+    RecordDialogStep(SessionStepType::kOpenDialog, option_name_);
+    int result = rrd.ShowModal();
+    RecordDialogStep(SessionStepType::kCloseDialog);
+    if (result != wxID_OK) {
       return;
     }
 
@@ -775,6 +900,7 @@ void FormOption::OnRandomClicked(wxCommandEvent& event) {
     }
   }
 
+  RecordValue();
   PopulateFromWorld();
 }
 
@@ -788,11 +914,15 @@ void FormOption::OnOptionSetClicked(wxCommandEvent& event) {
                               : game_option.default_value;
 
   OptionSetDialog osd(&game, option_name_, ov);
-  if (osd.ShowModal() != wxID_OK) {
+  RecordDialogStep(SessionStepType::kOpenDialog, option_name_);
+  int result = osd.ShowModal();
+  RecordDialogStep(SessionStepType::kCloseDialog);
+  if (result != wxID_OK) {
     return;
   }
 
   parent_->world_->SetOption(option_name_, osd.GetOptionValue());
+  RecordValue();
 }
 
 void FormOption::OnItemDictClicked(wxCommandEvent& event) {
@@ -805,11 +935,15 @@ void FormOption::OnItemDictClicked(wxCommandEvent& event) {
                               : game_option.default_value;
 
   ItemDictDialog idd(&game, option_name_, ov);
-  if (idd.ShowModal() != wxID_OK) {
+  RecordDialogStep(SessionStepType::kOpenDialog, option_name_);
+  int result = idd.ShowModal();
+  RecordDialogStep(SessionStepType::kCloseDialog);
+  if (result != wxID_OK) {
     return;
   }
 
   parent_->world_->SetOption(option_name_, idd.GetOptionValue());
+  RecordValue();
 }
 
 void FormOption::SaveToWorld() {
@@ -825,13 +959,84 @@ void FormOption::SaveToWorld() {
     new_value.int_value = numeric_picker_->GetValue();
   } else if (game_option.type == kSetOption) {
     if (list_box_ != nullptr) {
+      std::vector<bool>& set_values = new_value.set_values.Mutable();
       for (size_t i = 0; i < list_box_->GetCount(); i++) {
-        new_value.set_values.push_back(list_box_->IsChecked(i));
+        set_values.push_back(list_box_->IsChecked(i));
       }
     }
   }
 
   parent_->world_->SetOption(option_name_, std::move(new_value));
+  RecordValue();
+}
+
+void FormOption::ReplayValue(std::optional<OptionValue> option_value) {
+  const Game& game =
+      parent_->game_definitions_->GetGame(parent_->world_->GetGame());
+  const OptionDefinition& game_option = game.GetOption(option_name_);
+
+  const OptionValue& current_value =
+      parent_->world_->HasOption(option_name_)
+          ? parent_->world_->GetOption(option_name_)
+          : game_option.default_value;
+
+  // The controls are disabled while the value is random or invalid, and can
+  // only show plain values.
+  bool through_controls =
+      option_value && !current_value.random && current_value.errors.empty() &&
+      !option_value->random && option_value->errors.empty();
+
+  if (through_controls && game_option.type == kSelectOption &&
+      game_option.choices.HasValue(option_value->string_value)) {
+    combo_box_->SetSelection(
+        game_option.choices.GetValueId(option_value->string_value));
+
+    wxCommandEvent event;
+    OnSelectChanged(event);
+  } else if (through_controls && game_option.type == kRangeOption &&
+             option_value->int_value >= game_option.min_value &&
+             option_value->int_value <= game_option.max_value) {
+    numeric_picker_->ChangeValue(option_value->int_value);
+
+    wxCommandEvent event;
+    OnRangePickerChanged(event);
+  } else if (through_controls && list_box_ != nullptr &&
+             option_value->set_values->size() == list_box_->GetCount()) {
+    for (size_t i = 0; i < option_value->set_values->size(); i++) {
+      list_box_->Check(i, option_value->set_values->at(i));
+    }
+
+    wxCommandEvent event;
+    OnListItemChecked(event);
+  } else {
+    if (option_value) {
+      parent_->world_->SetOption(option_name_, std::move(*option_value));
+    } else {
+      parent_->world_->UnsetOption(option_name_);
+    }
+
+    RecordValue();
+    PopulateFromWorld();
+  }
+}
+
+void FormOption::RecordValue() {
+  if (!IsRecordingSession()) {
+    return;
+  }
+
+  SessionStep step;
+  step.type = SessionStepType::kSetOption;
+  step.option = option_name_;
+
+  if (parent_->world_->HasOption(option_name_)) {
+    const Game& game =
+        parent_->game_definitions_->GetGame(parent_->world_->GetGame());
+    step.value = OptionValueToYaml(game, option_name_,
+                                   parent_->world_->GetOption(option_name_));
+  }
+
+  RecordSessionStep(step);
 }
 
 }  // namespace
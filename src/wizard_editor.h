@@ -10,8 +10,12 @@
 #include <wx/scrolwin.h>
 
 #include <functional>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "game_definition.h"
+#include "window_pool.h"
 
 class World;
 
@@ -25,6 +29,20 @@ class WizardEditor : public wxScrolledWindow {
 
   virtual void SetMessageCallback(
       std::function<void(const wxString&, const wxString&)> callback) = 0;
+
+  virtual std::vector<WindowPoolStats> GetWindowPoolStats() const = 0;
+
+  // Make a recorded change through the same code as the form's controls, for
+  // replaying sessions. The form's confirmations are skipped. They throw
+  // std::runtime_error if the form has no such game, preset or option.
+  //
+  // An empty game unsets it, and a missing value unsets the option.
+  virtual void ReplaySetGame(const std::string& game) = 0;
+
+  virtual void ReplayApplyPreset(const std::string& preset) = 0;
+
+  virtual void ReplaySetOption(const std::string& option_name,
+                               std::optional<OptionValue> option_value) = 0;
 };
 
 WizardEditor* CreateWizardEditor(wxWindow* parent,
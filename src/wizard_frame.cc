@@ -2,11 +2,20 @@
 
 #include <wx/aboutdlg.h>
 #include <wx/listctrl.h>
+#include <wx/progdlg.h>
 #include <wx/splitter.h>
 
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
+#include <iostream>
 #include <sstream>
+#include <thread>
 
+#include "diagnostics_dialog.h"
+#include "parallel.h"
+#include "session_script.h"
+#include "util.h"
 #include "version.h"
 #include "world_window.h"
 
@@ -16,6 +25,8 @@ enum WizardFrameIds {
   ID_SAVE_WORLD = 3,
   ID_CLOSE_WORLD = 4,
   ID_SAVE_AS_WORLD = 5,
+  ID_LOAD_FOLDER = 6,
+  ID_DIAGNOSTICS = 7,
 };
 
 class WorldEntryData : public wxTreeItemData {
@@ -26,20 +37,27 @@ class WorldEntryData : public wxTreeItemData {
 };
 
 WizardFrame::WizardFrame()
-    : wxFrame(nullptr, wxID_ANY, "Archipelago Generation Wizard") {
+    : WizardFrame(std::make_unique<GameDefinitions>()) {}
+
+WizardFrame::WizardFrame(std::unique_ptr<GameDefinitions> game_definitions)
+    : wxFrame(nullptr, wxID_ANY, "Archipelago Generation Wizard"),
+      game_definitions_(std::move(game_definitions)) {
   SetSize(728, 728);
 
-  game_definitions_ = std::make_unique<GameDefinitions>();
+  file_writer_ = std::make_unique<BackgroundFileWriter>();
 
   wxMenu* menuFile = new wxMenu();
   menuFile->Append(ID_NEW_WORLD, "&New World\tCtrl-N");
   menuFile->Append(ID_LOAD_WORLD, "&Load World from File\tCtrl-O");
+  menuFile->Append(ID_LOAD_FOLDER,
+                   "Load Worlds from &Folder...\tCtrl-Shift-O");
   menuFile->Append(ID_SAVE_WORLD, "&Save World\tCtrl-S");
   menuFile->Append(ID_SAVE_AS_WORLD, "Save World As...\tCtrl-Shift-S");
   menuFile->Append(ID_CLOSE_WORLD, "&Close World\tCtrl-W");
   menuFile->Append(wxID_EXIT);
 
   wxMenu* menuHelp = new wxMenu();
+  menuHelp->Append(ID_DIAGNOSTICS, "&Diagnostics");
   menuHelp->Append(wxID_ABOUT);
 
   wxMenuBar* menuBar = new wxMenuBar();
@@ -50,11 +68,13 @@ WizardFrame::WizardFrame()
 
   Bind(wxEVT_MENU, &WizardFrame::OnNewWorld, this, ID_NEW_WORLD);
   Bind(wxEVT_MENU, &WizardFrame::OnLoadWorld, this, ID_LOAD_WORLD);
+  Bind(wxEVT_MENU, &WizardFrame::OnLoadFolder, this, ID_LOAD_FOLDER);
   Bind(wxEVT_MENU, &WizardFrame::OnSaveWorld, this, ID_SAVE_WORLD);
   Bind(wxEVT_MENU, &WizardFrame::OnSaveAsWorld, this, ID_SAVE_AS_WORLD);
   Bind(wxEVT_MENU, &WizardFrame::OnCloseWorld, this, ID_CLOSE_WORLD);
   Bind(wxEVT_MENU, &WizardFrame::OnExit, this, wxID_EXIT);
   Bind(wxEVT_MENU, &WizardFrame::OnAbout, this, wxID_ABOUT);
+  Bind(wxEVT_MENU, &WizardFrame::OnDiagnostics, this, ID_DIAGNOSTICS);
 
   Bind(wxEVT_CLOSE_WINDOW, &WizardFrame::OnClose, this);
 
@@ -107,11 +127,22 @@ WizardFrame::WizardFrame()
   SetSizer(sizer);
 }
 
+void WizardFrame::SetInteractive(bool interactive) {
+  interactive_ = interactive;
+  world_window_->SetInteractive(interactive);
+}
+
 void WizardFrame::OnNewWorld(wxCommandEvent& event) {
   if (!FlushSelectedWorld(/*ask_discard=*/true)) {
     return;
   }
 
+  if (IsRecordingSession()) {
+    SessionStep step;
+    step.type = SessionStepType::kNewWorld;
+    RecordSessionStep(step);
+  }
+
   InitializeWorld(std::make_unique<World>(game_definitions_.get()));
 }
 
@@ -120,23 +151,65 @@ void WizardFrame::OnLoadWorld(wxCommandEvent& event) {
     return;
   }
 
-  wxFileDialog openFileDialog(this, "Open World YAML", "", "",
-                              "YAML files (*.yaml;*.yml)|*.yaml;*.yml",
-                              wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+  wxFileDialog openFileDialog(
+      this, "Open World YAML", "", "",
+      "YAML files (*.yaml;*.yml)|*.yaml;*.yml",
+      wxFD_OPEN | wxFD_FILE_MUST_EXIST | wxFD_MULTIPLE);
 
   if (openFileDialog.ShowModal() == wxID_CANCEL) {
     return;
   }
 
-  try {
-    std::unique_ptr<World> load_world =
-        std::make_unique<World>(game_definitions_.get());
-    load_world->Load(openFileDialog.GetPath().ToStdString());
+  wxArrayString paths;
+  openFileDialog.GetPaths(paths);
+
+  std::vector<std::string> filenames;
+  for (const wxString& path : paths) {
+    filenames.push_back(path.ToStdString());
+  }
+
+  LoadWorlds(filenames);
+}
+
+void WizardFrame::OnLoadFolder(wxCommandEvent& event) {
+  if (!FlushSelectedWorld(/*ask_discard=*/true)) {
+    return;
+  }
+
+  wxDirDialog openDirDialog(this, "Open Folder of World YAMLs", "",
+                            wxDD_DEFAULT_STYLE | wxDD_DIR_MUST_EXIST);
+
+  if (openDirDialog.ShowModal() == wxID_CANCEL) {
+    return;
+  }
 
-    InitializeWorld(std::move(load_world));
+  std::vector<std::string> filenames;
+  try {
+    for (const std::filesystem::directory_entry& entry :
+         std::filesystem::directory_iterator(
+             openDirDialog.GetPath().ToStdString())) {
+      std::string extension = entry.path().extension().string();
+      if (entry.is_regular_file() &&
+          (extension == ".yaml" || extension == ".yml")) {
+        filenames.push_back(entry.path().string());
+      }
+    }
   } catch (const std::exception& ex) {
-    wxMessageBox(ex.what(), "Error loading World", wxOK, this);
+    ShowError(ex.what(), "Error loading Worlds");
+
+    return;
+  }
+
+  if (filenames.empty()) {
+    ShowError("The folder does not contain any YAML files.",
+              "Error loading Worlds");
+
+    return;
   }
+
+  std::sort(filenames.begin(), filenames.end());
+
+  LoadWorlds(filenames);
 }
 
 void WizardFrame::OnSaveWorld(wxCommandEvent& event) {
@@ -203,7 +276,7 @@ void WizardFrame::OnCloseWorld(wxCommandEvent& event) {
     if (result == wxCANCEL) {
       return;
     } else if (result == wxYES) {
-      if (!AttemptSaveWorld(world)) {
+      if (!AttemptSaveWorld(world, /*force_dialog=*/false, /*wait=*/true)) {
         return;
       }
     }
@@ -213,6 +286,7 @@ void WizardFrame::OnCloseWorld(wxCommandEvent& event) {
   // runs the handlers. Thus we should not actually delete the old world until
   // afterwards.
   world_list_->Delete(world_list_->GetSelection());
+  world_window_->ForgetWorld(&world);
 
   auto it = std::find_if(
       worlds_.begin(), worlds_.end(),
@@ -236,6 +310,14 @@ void WizardFrame::OnClose(wxCloseEvent& event) {
     return;
   }
 
+  // Let any saves still in flight finish before going away.
+  file_writer_->Drain();
+
+  if (!ProcessSaveResults() && event.CanVeto()) {
+    event.Veto();
+    return;
+  }
+
   Destroy();
 }
 
@@ -252,6 +334,18 @@ void WizardFrame::OnAbout(wxCommandEvent& event) {
   wxAboutBox(about_info);
 }
 
+void WizardFrame::OnDiagnostics(wxCommandEvent& event) {
+  // The dialog is kept around once it has been opened, and is only hidden
+  // when it's closed.
+  if (!diagnostics_dialog_) {
+    diagnostics_dialog_ = new DiagnosticsDialog(this, game_definitions_.get(),
+                                                &worlds_, world_window_);
+  }
+
+  diagnostics_dialog_->Show();
+  diagnostics_dialog_->Raise();
+}
+
 void WizardFrame::OnWorldSelecting(wxTreeEvent& event) {
   if (!FlushSelectedWorld(/*ask_discard=*/true)) {
     event.Veto();
@@ -265,7 +359,31 @@ void WizardFrame::OnWorldSelected(wxTreeEvent& event) {
   } else {
     const WorldEntryData* data = dynamic_cast<WorldEntryData*>(
         world_list_->GetItemData(event.GetItem()));
+
+    // Worlds from files with many worlds are only parsed once they are used.
+    try {
+      data->world->EnsureLoaded();
+    } catch (const std::exception& ex) {
+      world_window_->UnloadWorld();
+
+      ShowError(ex.what(), "Error loading World");
+
+      return;
+    }
+
     world_window_->LoadWorld(data->world);
+
+    if (IsRecordingSession()) {
+      auto it = std::find_if(worlds_.begin(), worlds_.end(),
+                             [data](const std::unique_ptr<World>& w) {
+                               return w.get() == data->world;
+                             });
+
+      SessionStep step;
+      step.type = SessionStepType::kSelectWorld;
+      step.index = it - worlds_.begin();
+      RecordSessionStep(step);
+    }
   }
 }
 
@@ -281,7 +399,7 @@ void WizardFrame::OnWorldRightClick(wxTreeEvent& event) {
   PopupMenu(&popup_menu, ScreenToClient(wxGetMousePosition()));
 }
 
-void WizardFrame::InitializeWorld(std::unique_ptr<World> world) {
+void WizardFrame::InitializeWorld(std::unique_ptr<World> world, bool select) {
   int index = worlds_.size();
   worlds_.push_back(std::move(world));
 
@@ -295,7 +413,133 @@ void WizardFrame::InitializeWorld(std::unique_ptr<World> world) {
       [this, new_world, new_id] { UpdateWorldDisplay(new_world, new_id); });
 
   UpdateWorldDisplay(new_world, new_id);
-  world_list_->SelectItem(new_id);
+
+  if (select) {
+    world_list_->SelectItem(new_id);
+  }
+}
+
+void WizardFrame::LoadWorlds(const std::vector<std::string>& filenames) {
+  struct LoadResult {
+    std::vector<std::unique_ptr<World>> worlds;
+    std::optional<std::string> error;
+  };
+
+  if (IsRecordingSession()) {
+    SessionStep step;
+    step.type = SessionStepType::kOpen;
+    step.files = filenames;
+    RecordSessionStep(step);
+  }
+
+  // GameDefinitions is read-only once loaded, so the files can be parsed
+  // concurrently. The pool runs on its own thread so that the progress dialog
+  // stays responsive.
+  std::vector<LoadResult> results(filenames.size());
+  std::atomic<size_t> finished = 0;
+
+  std::thread loader([this, &filenames, &results, &finished] {
+    ParallelFor(filenames.size(), [&](size_t i) {
+      try {
+        results[i].worlds =
+            World::LoadAll(game_definitions_.get(), filenames[i]);
+      } catch (const std::exception& ex) {
+        results[i].error = ex.what();
+      }
+
+      finished++;
+    });
+  });
+
+  if (filenames.size() > 1) {
+    wxProgressDialog progress_dialog(
+        "Loading Worlds", "Loading worlds...", filenames.size(), this,
+        wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_ELAPSED_TIME);
+
+    while (finished < filenames.size()) {
+      progress_dialog.Update(finished);
+      wxMilliSleep(25);
+    }
+  }
+
+  loader.join();
+
+  if (filenames.size() == 1) {
+    if (results.front().error) {
+      ShowError(*results.front().error, "Error loading World");
+
+      return;
+    } else if (results.front().worlds.size() == 1) {
+      InitializeWorld(std::move(results.front().worlds.front()));
+
+      return;
+    }
+  }
+
+  wxString summary;
+  int loaded_files = 0;
+  int loaded_worlds = 0;
+
+  world_list_->Freeze();
+
+  for (size_t i = 0; i < filenames.size(); i++) {
+    std::filesystem::path filepath(filenames[i]);
+
+    if (results[i].error) {
+      summary << filepath.filename().c_str() << ": " << *results[i].error
+              << "\n";
+
+      continue;
+    }
+
+    for (std::unique_ptr<World>& world : results[i].worlds) {
+      wxString location = filepath.filename().c_str();
+      if (std::optional<size_t> document_index = world->GetDocumentIndex()) {
+        location << " #" << (*document_index + 1);
+      }
+
+      // Worlds from files with several worlds are only parsed once they're
+      // selected, so this has just the problems found while listing them.
+      // Any others are reported on selection.
+      if (const std::optional<std::string>& error = world->GetLoadError()) {
+        summary << location << ": " << *error << "\n";
+      }
+
+      std::vector<std::string> invalid_options = world->GetInvalidOptions();
+      if (!invalid_options.empty()) {
+        summary << location << ": Invalid values for "
+                << implode(invalid_options, ", ") << ".\n";
+      }
+
+      const std::vector<std::string>& unknown_options =
+          world->GetUnknownOptions();
+      if (!unknown_options.empty()) {
+        summary << location << ": Unknown options "
+                << implode(unknown_options, ", ") << ".\n";
+      }
+
+      InitializeWorld(std::move(world), /*select=*/false);
+      loaded_worlds++;
+    }
+
+    loaded_files++;
+  }
+
+  world_list_->Thaw();
+
+  if (loaded_worlds > 0) {
+    world_list_->SelectItem(
+        world_list_->GetLastChild(world_list_->GetRootItem()));
+  }
+
+  if (!summary.empty()) {
+    wxString message;
+    message << "Loaded " << loaded_files << " of " << filenames.size()
+            << " files.\n\n"
+            << summary;
+
+    ShowError(message, "Problems loading Worlds");
+  }
 }
 
 void WizardFrame::UpdateWorldDisplay(World* world, wxTreeItemId tree_item_id) {
@@ -320,12 +564,49 @@ void WizardFrame::UpdateWorldDisplay(World* world, wxTreeItemId tree_item_id) {
     std::filesystem::path filepath(world->GetFilename());
     world_display << " (";
     world_display << filepath.filename().c_str();
+
+    if (std::optional<size_t> document_index = world->GetDocumentIndex()) {
+      world_display << " #" << (*document_index + 1);
+    }
+
     world_display << ")";
   }
 
   world_list_->SetItemText(tree_item_id, world_display);
 }
 
+World* WizardFrame::GetSelectedWorld() const {
+  if (!world_list_->GetSelection().IsOk() ||
+      world_list_->GetRootItem() == world_list_->GetSelection()) {
+    return nullptr;
+  }
+
+  const WorldEntryData* data = dynamic_cast<WorldEntryData*>(
+      world_list_->GetItemData(world_list_->GetSelection()));
+  return data->world;
+}
+
+bool WizardFrame::SelectWorld(size_t index) {
+  if (index >= worlds_.size()) {
+    return false;
+  }
+
+  wxTreeItemId root_id = world_list_->GetRootItem();
+  wxTreeItemIdValue cookie;
+  for (wxTreeItemId item_id = world_list_->GetFirstChild(root_id, cookie);
+       item_id.IsOk(); item_id = world_list_->GetNextChild(root_id, cookie)) {
+    const WorldEntryData* data =
+        dynamic_cast<WorldEntryData*>(world_list_->GetItemData(item_id));
+    if (data->world == worlds_[index].get()) {
+      world_list_->SelectItem(item_id);
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void WizardFrame::ShowMessage(const wxString& header, const wxString& msg) {
   for (int i = 0; i < 2; i++) {
     int width = message_window_->GetClientSize().GetWidth();
@@ -342,6 +623,15 @@ void WizardFrame::ShowMessage(const wxString& header, const wxString& msg) {
   }
 }
 
+void WizardFrame::ShowError(const wxString& message, const wxString& caption) {
+  if (interactive_) {
+    wxMessageBox(message, caption, wxOK, this);
+  } else {
+    std::cerr << caption.ToStdString() << ": " << message.ToStdString()
+              << std::endl;
+  }
+}
+
 bool WizardFrame::FlushSelectedWorld(bool ask_discard) {
   if (!world_list_->GetSelection().IsOk() ||
       world_list_->GetRootItem() == world_list_->GetSelection()) {
@@ -355,15 +645,15 @@ bool WizardFrame::FlushSelectedWorld(bool ask_discard) {
     msg << "Could not save world.\n\n";
     msg << ex.what();
 
-    if (ask_discard) {
-      msg << "\n\nWould you like to discard your changes?";
+    if (!ask_discard || !interactive_) {
+      ShowError(msg, "Failure to save world");
 
-      if (wxMessageBox(msg, "Failure to save world", wxYES_NO) == wxNO) {
-        return false;
-      }
-    } else {
-      wxMessageBox(msg, "Failure to save world");
+      return false;
+    }
+
+    msg << "\n\nWould you like to discard your changes?";
 
+    if (wxMessageBox(msg, "Failure to save world", wxYES_NO) == wxNO) {
       return false;
     }
   }
@@ -399,7 +689,8 @@ bool WizardFrame::FlushAllWorlds() {
       if (result == wxCANCEL) {
         return false;
       } else if (result == wxYES) {
-        if (!AttemptSaveWorld(*world)) {
+        if (!AttemptSaveWorld(*world, /*force_dialog=*/false,
+                              /*wait=*/true)) {
           return false;
         }
       }
@@ -409,7 +700,11 @@ bool WizardFrame::FlushAllWorlds() {
   return true;
 }
 
-bool WizardFrame::AttemptSaveWorld(World& world, bool force_dialog) {
+bool WizardFrame::AttemptSaveWorld(World& world, bool force_dialog,
+                                   bool wait) {
+  SessionStep step;
+  step.type = SessionStepType::kSave;
+
   if (!world.HasFilename() || force_dialog) {
     wxFileDialog saveFileDialog(this, "Save World YAML", "", "",
                                 "YAML files (*.yaml;*.yml)|*.yaml;*.yml",
@@ -420,15 +715,61 @@ bool WizardFrame::AttemptSaveWorld(World& world, bool force_dialog) {
     }
 
     world.SetFilename(saveFileDialog.GetPath().ToStdString());
+    step.file = world.GetFilename();
   }
 
-  try {
-    world.Save(world.GetFilename());
-  } catch (const std::exception& ex) {
-    wxMessageBox(ex.what(), "Error saving World", wxOK, this);
+  if (IsRecordingSession()) {
+    RecordSessionStep(step);
+  }
 
-    return false;
+  // The text is produced here, but written out on the writer's thread. The
+  // world is only marked as saved if it hasn't changed in the meantime.
+  //
+  // A world from a file with several worlds writes the whole file, with the
+  // other documents as they were last loaded or saved. Saving it somewhere
+  // else with "Save As" detaches it, so the new file has just this world.
+  uint64_t generation = world.GetGeneration();
+  file_writer_->Submit(
+      world.GetFilename(), world.GetFileSnapshot(),
+      [this, generation](std::optional<std::string> error) {
+        {
+          std::lock_guard lock(save_results_mutex_);
+          save_results_.push_back({generation, std::move(error)});
+        }
+
+        CallAfter([this] { ProcessSaveResults(); });
+      });
+
+  if (wait) {
+    file_writer_->Drain();
+
+    return ProcessSaveResults();
   }
 
   return true;
 }
+
+bool WizardFrame::ProcessSaveResults() {
+  std::vector<SaveResult> save_results;
+
+  {
+    std::lock_guard lock(save_results_mutex_);
+    save_results.swap(save_results_);
+  }
+
+  bool success = true;
+  for (const SaveResult& save_result : save_results) {
+    if (save_result.error) {
+      ShowError(*save_result.error, "Error saving World");
+
+      success = false;
+    } else {
+      // Generations are unique, so at most one world can match.
+      for (std::unique_ptr<World>& world : worlds_) {
+        world->MarkSaved(save_result.generation);
+      }
+    }
+  }
+
+  return success;
+}
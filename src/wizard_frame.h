@@ -9,9 +9,18 @@
 
 #include <wx/treectrl.h>
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "file_writer.h"
 #include "game_definition.h"
 #include "world.h"
 
+class DiagnosticsDialog;
 class wxListView;
 class WorldWindow;
 class wxSplitterWindow;
@@ -20,26 +29,53 @@ class WizardFrame : public wxFrame {
  public:
   WizardFrame();
 
+  explicit WizardFrame(std::unique_ptr<GameDefinitions> game_definitions);
+
+  // A frame that isn't interactive writes the errors it would show in message
+  // boxes to stderr, and keeps unsaved edits rather than asking whether to
+  // discard them, so that sessions can be replayed unattended.
+  void SetInteractive(bool interactive);
+
  private:
+  // Drives the frame through the same methods as the menus and tree do.
+  friend class SessionReplayer;
+
   void OnNewWorld(wxCommandEvent& event);
   void OnLoadWorld(wxCommandEvent& event);
+  void OnLoadFolder(wxCommandEvent& event);
   void OnSaveWorld(wxCommandEvent& event);
   void OnSaveAsWorld(wxCommandEvent& event);
   void OnCloseWorld(wxCommandEvent& event);
   void OnExit(wxCommandEvent& event);
   void OnClose(wxCloseEvent& event);
   void OnAbout(wxCommandEvent& event);
+  void OnDiagnostics(wxCommandEvent& event);
   void OnWorldSelecting(wxTreeEvent& event);
   void OnWorldSelected(wxTreeEvent& event);
   void OnWorldRightClick(wxTreeEvent& event);
 
-  void InitializeWorld(std::unique_ptr<World> world);
+  void InitializeWorld(std::unique_ptr<World> world, bool select = true);
+  void LoadWorlds(const std::vector<std::string>& filenames);
   void SyncWorldIndices();
   void UpdateWorldDisplay(World* world, wxTreeItemId tree_item_id);
+  // Returns nullptr if no world is selected.
+  World* GetSelectedWorld() const;
+  // Selects the world at the index in worlds_. Returns false if there isn't
+  // one.
+  bool SelectWorld(size_t index);
   void ShowMessage(const wxString& header, const wxString& msg);
+  // Shows the error in a message box, or on stderr if not interactive.
+  void ShowError(const wxString& message, const wxString& caption);
   bool FlushSelectedWorld(bool ask_discard);
   bool FlushAllWorlds();
-  bool AttemptSaveWorld(World& world, bool force_dialog = false);
+  // Saves in the background unless wait is set, in which case the result is
+  // known (and reported) by the time this returns.
+  bool AttemptSaveWorld(World& world, bool force_dialog = false,
+                        bool wait = false);
+
+  // Reports the saves that have finished since the last call. Returns false if
+  // any of them failed.
+  bool ProcessSaveResults();
 
   wxSplitterWindow* splitter_window_;
   wxTreeCtrl* world_list_;
@@ -50,9 +86,22 @@ class WizardFrame : public wxFrame {
   wxStaticText* message_header_;
   wxStaticText* message_window_;
 
+  DiagnosticsDialog* diagnostics_dialog_ = nullptr;
+
+  bool interactive_ = true;
+
   std::unique_ptr<GameDefinitions> game_definitions_;
 
   std::vector<std::unique_ptr<World>> worlds_;
+
+  struct SaveResult {
+    uint64_t generation;
+    std::optional<std::string> error;
+  };
+
+  std::unique_ptr<BackgroundFileWriter> file_writer_;
+  std::mutex save_results_mutex_;
+  std::vector<SaveResult> save_results_;
 };
 
 #endif /* end of include guard: WIZARD_FRAME_H_E923FBAE */
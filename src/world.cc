@@ -1,14 +1,36 @@
 #include "world.h"
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
-#include <sstream>
+#include <iterator>
+#include <set>
 #include <stdexcept>
 
-#include "util.h"
-#include "wizard_frame.h"
+#include "allocation_counter.h"
+#include "file_writer.h"
+#include "memory_usage.h"
+#include "string_view_stream.h"
+#include "timing_stats.h"
+#include "trace.h"
+#include "core_util.h"
+#include "yaml_outline.h"
+#include "yaml_writer.h"
 
 namespace {
 
+Diagnostic MakeDiagnostic(DiagnosticCode code, const OptionDefinition& option,
+                          std::string value, const YAML::Node& node) {
+  Diagnostic diagnostic;
+  diagnostic.code = code;
+  diagnostic.option = &option;
+  diagnostic.value = std::move(value);
+  diagnostic.line = node.Mark().line;
+  diagnostic.column = node.Mark().column;
+
+  return diagnostic;
+}
+
 OptionValue OptionValueForChoiceValue(const OptionDefinition& option,
                                       const YAML::Node& node) {
   OptionValue option_value;
@@ -27,20 +49,13 @@ OptionValue OptionValueForChoiceValue(const OptionDefinition& option,
       if (option.choices.HasKey(int_val)) {
         option_value.int_value = int_val;
       } else {
-        wxString error;
-        error << "Unknown ID \"";
-        error << int_val;
-        error << "\".";
-
-        option_value.error = error.ToStdString();
+        option_value.errors.push_back(
+            MakeDiagnostic(DiagnosticCode::kUnknownChoiceId, option,
+                           std::move(str_val), node));
       }
     } catch (const std::invalid_argument&) {
-      wxString error;
-      error << "Unknown value \"";
-      error << str_val;
-      error << "\".";
-
-      option_value.error = error.ToStdString();
+      option_value.errors.push_back(MakeDiagnostic(
+          DiagnosticCode::kUnknownChoice, option, std::move(str_val), node));
     }
   }
 
@@ -54,6 +69,13 @@ OptionValue OptionValueForRangeValue(const OptionDefinition& option,
   std::string str_val = node.as<std::string>();
   if (str_val.starts_with("random")) {
     option_value = GetRandomOptionValueFromString(str_val);
+
+    // The specifier parser doesn't know where the value came from.
+    for (Diagnostic& diagnostic : option_value.errors) {
+      diagnostic.option = &option;
+      diagnostic.line = node.Mark().line;
+      diagnostic.column = node.Mark().column;
+    }
   } else if (option.value_names.HasValue(str_val)) {
     option_value.int_value = option.value_names.GetByValue(str_val);
   } else {
@@ -62,47 +84,403 @@ OptionValue OptionValueForRangeValue(const OptionDefinition& option,
 
       if (!option.value_names.HasKey(option_value.int_value)) {
         if (option_value.int_value < option.min_value) {
-          wxString error;
-          error << "Value ";
-          error << str_val;
-          error << " is too small.";
-
-          option_value.error = error.ToStdString();
+          option_value.errors.push_back(
+              MakeDiagnostic(DiagnosticCode::kValueTooSmall, option,
+                             std::move(str_val), node));
         } else if (option_value.int_value > option.max_value) {
-          wxString error;
-          error << "Value ";
-          error << str_val;
-          error << " is too large.";
-
-          option_value.error = error.ToStdString();
+          option_value.errors.push_back(
+              MakeDiagnostic(DiagnosticCode::kValueTooLarge, option,
+                             std::move(str_val), node));
         }
       }
     } catch (const std::exception&) {
-      wxString error;
-      error << "Invalid value \"";
-      error << str_val;
-      error << "\".";
+      option_value.errors.push_back(
+          MakeDiagnostic(DiagnosticCode::kInvalidRangeValue, option,
+                         std::move(str_val), node));
+    }
+  }
+
+  return option_value;
+}
+
+OptionValue OptionValueForNode(const Game& game, const OptionDefinition& option,
+                               const YAML::Node& node) {
+  OptionValue option_value;
+
+  if (option.type == kSelectOption || option.type == kRangeOption) {
+    // Choices and ranges can both be weighted.
+    if (node.IsScalar()) {
+      if (option.type == kSelectOption) {
+        option_value = OptionValueForChoiceValue(option, node);
+      } else if (option.type == kRangeOption) {
+        option_value = OptionValueForRangeValue(option, node);
+      }
+    } else if (node.IsMap()) {
+      option_value.random = true;
+
+      std::vector<Diagnostic> errors;
+      for (YAML::const_iterator it = node.begin(); it != node.end(); it++) {
+        OptionValue sub_option_value;
+        if (option.type == kSelectOption) {
+          sub_option_value = OptionValueForChoiceValue(option, it->first);
+        } else if (option.type == kRangeOption) {
+          sub_option_value = OptionValueForRangeValue(option, it->first);
+        }
+
+        for (Diagnostic& diagnostic : sub_option_value.errors) {
+          errors.push_back(std::move(diagnostic));
+        }
+        sub_option_value.errors.clear();
+
+        try {
+          sub_option_value.weight = it->second.as<int>();
+        } catch (const std::exception&) {
+          errors.push_back(MakeDiagnostic(DiagnosticCode::kNonNumericWeight,
+                                          option,
+                                          it->second.as<std::string>(),
+                                          it->second));
+        }
+
+        if (sub_option_value.weight > 0) {
+          option_value.weighting.Mutable().push_back(
+              std::move(sub_option_value));
+        }
+      }
+
+      if (option_value.weighting->size() == 1) {
+        OptionValue sub_option_value = option_value.weighting->front();
+        option_value = std::move(sub_option_value);
+      }
 
-      option_value.error = error.ToStdString();
+      option_value.errors = std::move(errors);
+    }
+  } else if (option.type == kSetOption) {
+    const DoubleMap<std::string>& option_set =
+        GetOptionSetElements(game, option.name);
+    std::vector<bool>& set_values = option_value.set_values.Mutable();
+    set_values.resize(option_set.size());
+
+    if (node.IsSequence()) {
+      for (const YAML::Node& set_value : node) {
+        std::string str_val = set_value.as<std::string>();
+        if (option_set.HasValue(str_val)) {
+          set_values[option_set.GetId(str_val)] = true;
+        } else {
+          option_value.errors.push_back(
+              MakeDiagnostic(DiagnosticCode::kInvalidSetValue, option,
+                             std::move(str_val), set_value));
+        }
+      }
+    } else {
+      option_value.errors.push_back(
+          MakeDiagnostic(DiagnosticCode::kExpectedList, option, "", node));
+    }
+  } else if (option.type == kDictOption) {
+    const DoubleMap<std::string>& option_set =
+        GetOptionSetElements(game, option.name);
+
+    if (node.IsMap()) {
+      for (YAML::const_iterator it = node.begin(); it != node.end(); it++) {
+        std::string str_val = it->first.as<std::string>();
+        int int_val = it->second.as<int>();
+
+        if (option_set.HasValue(str_val)) {
+          option_value.dict_values.Mutable()[option_set.GetId(str_val)] =
+              int_val;
+        } else {
+          option_value.errors.push_back(
+              MakeDiagnostic(DiagnosticCode::kInvalidSetValue, option,
+                             std::move(str_val), it->first));
+        }
+      }
+    } else {
+      option_value.errors.push_back(
+          MakeDiagnostic(DiagnosticCode::kExpectedMap, option, "", node));
     }
   }
 
   return option_value;
 }
 
+// Moves the positions of the value's diagnostics down by the given number of
+// lines, for values parsed out of part of a document.
+void OffsetDiagnostics(OptionValue& option_value, int lines) {
+  for (Diagnostic& diagnostic : option_value.errors) {
+    if (diagnostic.line >= 0) {
+      diagnostic.line += lines;
+    }
+  }
+}
+
+// Parses the lines of a single mapping entry, returning its value, or an
+// invalid node if the lines are not exactly that one entry.
+YAML::Node ParseOutlineEntry(const std::vector<std::string_view>& lines,
+                             const YamlOutlineEntry& entry) {
+  YAML::Node node =
+      YAML::Load(ExtractYamlLines(lines, entry.first_line, entry.last_line));
+
+  if (!node.IsMap() || node.size() != 1 ||
+      node.begin()->first.as<std::string>() != entry.key) {
+    return YAML::Node(YAML::NodeType::Undefined);
+  }
+
+  return node.begin()->second;
+}
+
+// Whether values of the option can be written from their typed form. Options
+// of any other type are kept as written.
+bool HasTypedForm(const OptionDefinition& option) {
+  return option.type == kSelectOption || option.type == kRangeOption ||
+         option.type == kSetOption || option.type == kDictOption;
+}
+
+template <typename Entries>
+auto FindEntry(Entries& entries, std::string_view key) {
+  return std::find_if(entries.begin(), entries.end(),
+                      [key](const auto& entry) { return entry.key == key; });
+}
+
+// Makes sure that the key has an entry, written from the typed state. New
+// entries go at the end, as yaml-cpp would put them.
+template <typename Entry>
+void AddTypedEntry(std::vector<Entry>& entries, const std::string& key) {
+  auto entry = FindEntry(entries, key);
+  if (entry == entries.end()) {
+    entries.push_back({key});
+  } else {
+    entry->raw.reset();
+  }
+}
+
+template <typename Entry>
+void RemoveEntry(std::vector<Entry>& entries, std::string_view key) {
+  auto entry = FindEntry(entries, key);
+  if (entry != entries.end()) {
+    entries.erase(entry);
+  }
+}
+
+// Writes the option from its typed value. The option must have a typed form.
+void WriteOptionValue(YamlWriter& writer, const Game& game,
+                      const OptionDefinition& option,
+                      const OptionValue& option_value, int indent) {
+  if (option.type == kSelectOption) {
+    auto write_choice_key = [&writer, indent](const OptionValue& value) {
+      if (value.random) {
+        writer.WriteKey("random", indent);
+      } else if (value.string_value.empty()) {
+        writer.WriteIntKey(value.int_value, indent);
+      } else {
+        writer.WriteKey(value.string_value, indent);
+      }
+    };
+
+    if (option_value.random && !option_value.weighting->empty()) {
+      writer.BeginBlockValue();
+
+      for (const OptionValue& weight_value : *option_value.weighting) {
+        write_choice_key(weight_value);
+        writer.WriteIntValue(weight_value.weight);
+      }
+    } else if (option_value.random) {
+      writer.WriteScalarValue("random");
+    } else if (option_value.string_value.empty()) {
+      writer.WriteIntValue(option_value.int_value);
+    } else {
+      writer.WriteScalarValue(option_value.string_value);
+    }
+  } else if (option.type == kRangeOption) {
+    if (option_value.random && !option_value.weighting->empty()) {
+      writer.BeginBlockValue();
+
+      for (const OptionValue& weight_value : *option_value.weighting) {
+        if (weight_value.random) {
+          writer.WriteKey(FormatRandomOptionValue(weight_value).view(),
+                          indent);
+        } else if (option.value_names.HasKey(weight_value.int_value)) {
+          writer.WriteKey(option.value_names.GetByKey(weight_value.int_value),
+                          indent);
+        } else {
+          writer.WriteIntKey(weight_value.int_value, indent);
+        }
+
+        writer.WriteIntValue(weight_value.weight);
+      }
+    } else if (option_value.random) {
+      writer.WriteScalarValue(FormatRandomOptionValue(option_value).view());
+    } else if (option.value_names.HasKey(option_value.int_value)) {
+      writer.WriteScalarValue(
+          option.value_names.GetByKey(option_value.int_value));
+    } else {
+      writer.WriteIntValue(option_value.int_value);
+    }
+  } else if (option.type == kSetOption) {
+    const DoubleMap<std::string>& option_set =
+        GetOptionSetElements(game, option.name);
+
+    bool any_set = false;
+    for (size_t i = 0; i < option_value.set_values->size(); i++) {
+      if (option_value.set_values->at(i)) {
+        if (!any_set) {
+          writer.BeginBlockValue();
+          any_set = true;
+        }
+
+        writer.WriteSequenceItem(option_set.GetValue(i), indent);
+      }
+    }
+
+    if (!any_set) {
+      writer.WriteRawValue("[]");
+    }
+  } else if (option.type == kDictOption) {
+    const DoubleMap<std::string>& option_set =
+        GetOptionSetElements(game, option.name);
+
+    if (option_value.dict_values->empty()) {
+      writer.WriteRawValue("{}");
+    } else {
+      writer.BeginBlockValue();
+
+      for (const auto& [id, amount] : *option_value.dict_values) {
+        writer.WriteKey(option_set.GetValue(id), indent);
+        writer.WriteIntValue(amount);
+      }
+    }
+  }
+}
+
+std::string GetUnsupportedGameError(const std::string& game) {
+  return "Game \"" + game + "\" is not supported.";
+}
+
+// Generations are unique across all worlds, so that a generation identifies
+// both the world and its state.
+uint64_t NextGeneration() {
+  static std::atomic<uint64_t> next_generation = 1;
+  return next_generation++;
+}
+
 }  // namespace
 
 void World::Load(const std::string& filename) {
-  yaml_ = YAML::LoadFile(filename);
+  TRACE_SPAN("World::Load", filename);
+  ScopedTiming timing(TimedOperation::kWorldLoad);
+  ALLOCATION_PROBE("Load world");
+
+  YAML::Node root = YAML::LoadFile(filename);
   filename_ = filename;
+  MarkChanged();
+
+  PopulateFromYaml(root);
+}
+
+std::vector<std::unique_ptr<World>> World::LoadAll(
+    const GameDefinitions* game_definitions, const std::string& filename) {
+  TRACE_SPAN("World::LoadAll", filename);
+  ScopedTiming timing(TimedOperation::kWorldLoad);
+  ALLOCATION_PROBE("Load world");
+
+  std::ifstream file_stream(filename, std::ios::binary);
+  if (!file_stream) {
+    throw YAML::BadFile(filename);
+  }
+
+  std::string text{std::istreambuf_iterator<char>(file_stream),
+                   std::istreambuf_iterator<char>()};
+
+  std::vector<std::unique_ptr<World>> worlds;
+
+  auto source = std::make_shared<YamlSource>(filename, text);
+  if (source->GetDocumentCount() <= 1) {
+    std::unique_ptr<World> world = std::make_unique<World>(game_definitions);
+    world->FromYaml(text);
+    world->filename_ = filename;
+
+    worlds.push_back(std::move(world));
+
+    return worlds;
+  }
+
+  for (size_t i = 0; i < source->GetDocumentCount(); i++) {
+    std::unique_ptr<World> world = std::make_unique<World>(game_definitions);
+
+    // One bad document shouldn't keep the others from being opened.
+    try {
+      world->LoadDocument(source, i);
+    } catch (const std::exception& ex) {
+      world->load_error_ = ex.what();
+    }
 
-  PopulateFromYaml();
+    worlds.push_back(std::move(world));
+  }
+
+  return worlds;
+}
+
+void World::EnsureLoaded() {
+  if (loaded_) {
+    return;
+  }
+
+  if (load_error_) {
+    throw std::invalid_argument(*load_error_);
+  }
+
+  TRACE_SPAN("World::EnsureLoaded");
+  ScopedTiming timing(TimedOperation::kWorldParse);
+  ALLOCATION_PROBE("Parse world");
+
+  // The cached text is still the document as loaded, since nothing can change
+  // the world before this is called.
+  try {
+    StringViewIStream text_stream(*yaml_text_);
+    PopulateFromYaml(YAML::Load(text_stream));
+  } catch (const YAML::Exception& ex) {
+    // The document is only part of the file the user would look in.
+    if (ex.mark.is_null()) {
+      throw;
+    }
+
+    YAML::Mark mark = ex.mark;
+    mark.line += GetFirstLine();
+    throw YAML::Exception(mark, ex.msg);
+  }
+
+  loaded_ = true;
+}
+
+std::optional<size_t> World::GetDocumentIndex() const {
+  if (source_) {
+    return source_index_;
+  }
+
+  return std::nullopt;
+}
+
+int World::GetFirstLine() const {
+  if (source_) {
+    return source_->GetDocumentLine(source_index_);
+  }
+
+  return 0;
+}
+
+void World::SetFilename(const std::string& val) {
+  if (source_ && val != source_->GetFilename()) {
+    source_.reset();
+  }
+
+  filename_ = val;
 }
 
 void World::SetName(std::string name) {
+  EnsureLoaded();
+
   name_ = name;
 
-  yaml_["name"] = name_;
+  AddTypedEntry(entries_, "name");
+  MarkChanged();
 
   if (meta_update_callback_) {
     meta_update_callback_();
@@ -110,43 +488,119 @@ void World::SetName(std::string name) {
 }
 
 void World::SetDescription(const std::string& v) {
+  EnsureLoaded();
+
   description_ = v;
 
-  yaml_["description"] = description_;
+  AddTypedEntry(entries_, "description");
+  MarkChanged();
 }
 
 void World::Save(const std::string& filename) {
-  std::ofstream file_stream(filename);
-  file_stream << yaml_ << std::endl;
+  TRACE_SPAN("World::Save", filename);
+
+  WriteFileAtomically(filename, *GetFileSnapshot());
 
   SetDirty(false);
 }
 
-void World::FromYaml(const std::string& text) {
-  YAML::Node old_node = Clone(yaml_);
-  yaml_ = YAML::Load(text);
+void World::MarkSaved(uint64_t generation) {
+  if (generation_ == generation) {
+    SetDirty(false);
+  }
+}
 
-  try {
-    PopulateFromYaml();
-  } catch (const std::exception&) {
-    yaml_ = old_node;
+void World::MarkPendingEdit() {
+  MarkChanged();
 
-    throw;
+  if (!dirty_) {
+    SetDirty(true);
   }
 }
 
-std::string World::ToYaml() const {
-  std::ostringstream str_stream;
-  str_stream << yaml_ << std::endl;
-  return str_stream.str();
+void World::FromYaml(std::string_view text) {
+  TRACE_SPAN("World::FromYaml");
+
+  StringViewIStream text_stream(text);
+  FromNode(YAML::Load(text_stream));
+}
+
+void World::FromYaml(std::string_view text,
+                     const std::vector<std::tuple<int, int>>& touched_lines) {
+  TRACE_SPAN("World::FromYaml (partial)");
+
+  EnsureLoaded();
+
+  if (!UpdateFromYaml(text, touched_lines)) {
+    FromYaml(text);
+  }
 }
 
+void World::FromNode(YAML::Node node) {
+  EnsureLoaded();
+
+  // Read into a separate world, so that a failure leaves this one untouched.
+  World parsed(game_definitions_);
+  parsed.PopulateFromYaml(node);
+
+  bool meta_changed = name_ != parsed.name_ || game_ != parsed.game_;
+
+  name_ = std::move(parsed.name_);
+  game_ = std::move(parsed.game_);
+  description_ = std::move(parsed.description_);
+  options_ = std::move(parsed.options_);
+  unknown_options_ = std::move(parsed.unknown_options_);
+  entries_ = std::move(parsed.entries_);
+  game_entries_ = std::move(parsed.game_entries_);
+  MarkChanged();
+
+  if (meta_changed && meta_update_callback_) {
+    meta_update_callback_();
+  }
+}
+
+std::string World::ToYaml() const { return GetYamlText(); }
+
+const std::string& World::GetYamlText() const { return *GetYamlSnapshot(); }
+
+std::shared_ptr<const std::string> World::GetYamlSnapshot() const {
+  if (!yaml_text_ || yaml_text_generation_ != generation_) {
+    yaml_text_ = std::make_shared<const std::string>(BuildYamlText());
+    yaml_text_generation_ = generation_;
+  }
+
+  return yaml_text_;
+}
+
+std::shared_ptr<const std::string> World::GetFileSnapshot() {
+  std::shared_ptr<const std::string> text = GetYamlSnapshot();
+  if (!source_) {
+    return text;
+  }
+
+  source_->SetDocument(source_index_, std::move(text));
+
+  return std::make_shared<const std::string>(source_->GetText());
+}
+
+void World::WriteYaml(std::ostream& output) const { output << GetYamlText(); }
+
 void World::SetGame(const std::string& game) {
-  UnsetGame();
+  EnsureLoaded();
+
+  // The options for the old game are dropped, but the "game" entry keeps its
+  // place in the document.
+  if (game_) {
+    RemoveEntry(entries_, *game_);
+  }
 
   game_ = game;
-  yaml_["game"] = game;
+  options_.clear();
+  unknown_options_.clear();
+  game_entries_.clear();
+  AddTypedEntry(entries_, "game");
   dirty_ = true;
+  MarkChanged();
 
   if (meta_update_callback_) {
     meta_update_callback_();
@@ -154,13 +608,19 @@ void World::SetGame(const std::string& game) {
 }
 
 void World::UnsetGame() {
-  if (game_ && yaml_[*game_]) {
-    yaml_.remove(*game_);
+  EnsureLoaded();
+
+  if (game_) {
+    RemoveEntry(entries_, *game_);
   }
+  RemoveEntry(entries_, "game");
 
   game_ = std::nullopt;
   dirty_ = true;
   options_.clear();
+  unknown_options_.clear();
+  game_entries_.clear();
+  MarkChanged();
 
   if (meta_update_callback_) {
     meta_update_callback_();
@@ -171,12 +631,30 @@ bool World::HasOption(const std::string& option_name) const {
   return options_.count(option_name);
 }
 
-const OptionValue& World::GetOption(const std::string& option_name) const {
-  return options_.at(option_name);
+OptionValue World::GetOption(const std::string& option_name) const {
+  return ToOptionValue(options_.at(option_name));
+}
+
+const std::vector<Diagnostic>& World::GetOptionErrors(
+    const std::string& option_name) const {
+  return *options_.at(option_name).errors;
 }
 
 void World::SetOption(const std::string& option_name,
                       OptionValue option_value) {
+  ALLOCATION_PROBE("Set option");
+
+  EnsureLoaded();
+
+  CompactOptionValue compact_value =
+      ToCompactOptionValue(std::move(option_value));
+
+  // Editors write back whatever they show, so most writes change nothing.
+  auto existing = options_.find(option_name);
+  if (existing != options_.end() && existing->second == compact_value) {
+    return;
+  }
+
   const Game& game = game_definitions_->GetGame(*game_);
   const OptionDefinition& option = game.GetOption(option_name);
 
@@ -184,245 +662,507 @@ void World::SetOption(const std::string& option_name,
     SetDirty(true);
   }
 
-  yaml_[*game_].remove(option_name);
-  if (option.type == kSelectOption) {
-    if (option_value.random) {
-      if (option_value.weighting.empty()) {
-        yaml_[*game_][option_name] = "random";
-      } else {
-        for (const OptionValue& weight_value : option_value.weighting) {
-          yaml_[*game_][option_name][weight_value.string_value] =
-              weight_value.weight;
-        }
-      }
-    } else {
-      yaml_[*game_][option_name] = option_value.string_value;
+  // The document is written from the typed value when it is next needed, so
+  // nothing else has to change here.
+  if (HasTypedForm(option)) {
+    AddTypedEntry(entries_, *game_);
+    AddTypedEntry(game_entries_, option_name);
+  }
+
+  options_[option_name] = std::move(compact_value);
+  MarkChanged();
+}
+
+void World::UnsetOption(const std::string& option_name) {
+  EnsureLoaded();
+
+  options_.erase(option_name);
+  MarkChanged();
+
+  RemoveEntry(game_entries_, option_name);
+  UpdateGameSection();
+}
+
+std::vector<std::string> World::GetInvalidOptions() const {
+  std::vector<std::string> invalid_options;
+  for (const auto& [option_name, option_value] : options_) {
+    if (!option_value.errors->empty()) {
+      invalid_options.push_back(option_name);
     }
-  } else if (option.type == kRangeOption) {
-    if (option_value.random) {
-      if (option_value.weighting.empty()) {
-        yaml_[*game_][option_name] = RandomOptionValueToString(option_value);
-      } else {
-        for (const OptionValue& weight_value : option_value.weighting) {
-          if (weight_value.random) {
-            yaml_[*game_][option_name]
-                 [RandomOptionValueToString(weight_value)] =
-                     weight_value.weight;
-          } else if (option.value_names.HasKey(weight_value.int_value)) {
-            yaml_[*game_][option_name]
-                 [option.value_names.GetByKey(weight_value.int_value)] =
-                     weight_value.weight;
-          } else {
-            yaml_[*game_][option_name][weight_value.int_value] =
-                weight_value.weight;
-          }
-        }
-      }
-    } else if (option.value_names.HasKey(option_value.int_value)) {
-      yaml_[*game_][option_name] =
-          option.value_names.GetByKey(option_value.int_value);
-    } else {
-      yaml_[*game_][option_name] = option_value.int_value;
+  }
+
+  return invalid_options;
+}
+
+void World::ApplyOptions(const PresetOptions& options) {
+  EnsureLoaded();
+
+  const Game& game = game_definitions_->GetGame(*game_);
+
+  options_.clear();
+
+  // Keys that don't name an option stay, as they aren't shown anywhere.
+  std::erase_if(game_entries_, [&game](const Entry& entry) {
+    return game.FindOption(entry.key) != nullptr;
+  });
+
+  for (const auto& [option_index, option_value] : options) {
+    const OptionDefinition& option = game.GetOptions()[option_index];
+    options_.emplace(option.name, option_value);
+
+    if (HasTypedForm(option)) {
+      game_entries_.push_back({option.name});
     }
-  } else if (option.type == kSetOption) {
-    yaml_[*game_].remove(option_name);
+  }
 
-    const DoubleMap<std::string>& option_set =
-        GetOptionSetElements(game, option_name);
-    bool any_set = false;
-    for (int i = 0; i < option_value.set_values.size(); i++) {
-      if (option_value.set_values.at(i)) {
-        any_set = true;
+  UpdateGameSection();
+  MarkChanged();
+
+  if (!dirty_) {
+    SetDirty(true);
+  }
+}
+
+void World::ClearOptions() { ApplyOptions({}); }
+
+void World::MarkChanged() { generation_ = NextGeneration(); }
+
+void World::UpdateGameSection() {
+  auto game_entry = FindEntry(entries_, *game_);
+
+  if (!game_entries_.empty()) {
+    AddTypedEntry(entries_, *game_);
+  } else if (game_entry != entries_.end() && !game_entry->raw) {
+    entries_.erase(game_entry);
+  }
+}
+
+size_t World::GetMemoryUsage() const {
+  size_t size = sizeof(World) + ::GetMemoryUsage(name_) +
+                ::GetMemoryUsage(description_);
+
+  if (game_) {
+    size += ::GetMemoryUsage(*game_);
+  }
+
+  if (filename_) {
+    size += ::GetMemoryUsage(*filename_);
+  }
 
-        yaml_[*game_][option_name].push_back(option_set.GetValue(i));
+  for (const auto& [option_name, option_value] : options_) {
+    // The map's node, which holds both the name and the value.
+    size += 4 * sizeof(void*) + sizeof(std::string) +
+            sizeof(CompactOptionValue) +
+            ::GetMemoryUsage(option_name) + ::GetMemoryUsage(option_value);
+  }
+
+  size += unknown_options_.capacity() * sizeof(std::string);
+  for (const std::string& option_name : unknown_options_) {
+    size += ::GetMemoryUsage(option_name);
+  }
+
+  for (const std::vector<Entry>* entries : {&entries_, &game_entries_}) {
+    size += entries->capacity() * sizeof(Entry);
+    for (const Entry& entry : *entries) {
+      size += ::GetMemoryUsage(entry.key);
+      if (entry.raw) {
+        size += ::GetMemoryUsage(*entry.raw);
       }
     }
+  }
 
-    if (!any_set) {
-      yaml_[*game_][option_name] = YAML::Load("[]");
+  if (yaml_text_) {
+    size += ::GetMemoryUsage(*yaml_text_);
+  }
+
+  return size;
+}
+
+void World::LoadDocument(std::shared_ptr<YamlSource> source, size_t index) {
+  filename_ = source->GetFilename();
+  yaml_text_ = source->GetDocument(index);
+  yaml_text_generation_ = generation_;
+  source_ = std::move(source);
+  source_index_ = index;
+  loaded_ = false;
+
+  // Listing the world only needs its name, game and description, so read just
+  // those entries where the document is simple enough to find them.
+  std::vector<std::string_view> lines = SplitYamlLines(*yaml_text_);
+  std::optional<std::vector<YamlOutlineEntry>> outline =
+      OutlineYamlMap(lines, 0, lines.size() - 1);
+  if (!outline) {
+    EnsureLoaded();
+    return;
+  }
+
+  for (const YamlOutlineEntry& entry : *outline) {
+    if (entry.key != "name" && entry.key != "game" &&
+        entry.key != "description") {
+      continue;
     }
-  } else if (option.type == kDictOption) {
-    yaml_[*game_].remove(option_name);
 
-    const DoubleMap<std::string>& option_set =
-        GetOptionSetElements(game, option_name);
-    if (option_value.dict_values.empty()) {
-      yaml_[*game_][option_name] = YAML::Load("{}");
+    // Errors are left for the full parse to report, with their position in
+    // the file.
+    YAML::Node node;
+    try {
+      node = ParseOutlineEntry(lines, entry);
+    } catch (const YAML::Exception&) {
+      EnsureLoaded();
+      return;
+    }
+
+    if (!node.IsScalar()) {
+      EnsureLoaded();
+      return;
+    }
+
+    if (entry.key == "name") {
+      name_ = node.Scalar();
+    } else if (entry.key == "game") {
+      game_ = node.Scalar();
     } else {
-      for (const auto& [id, amount] : option_value.dict_values) {
-        yaml_[*game_][option_name][option_set.GetValue(id)] = amount;
-      }
+      description_ = node.Scalar();
     }
   }
 
-  options_[option_name] = std::move(option_value);
+  if (game_ && !game_definitions_->HasGame(*game_)) {
+    throw std::invalid_argument(GetUnsupportedGameError(*game_));
+  }
 }
 
-void World::UnsetOption(const std::string& option_name) {
-  options_.erase(option_name);
+std::string World::BuildYamlText() const {
+  YamlWriter writer;
 
-  if (yaml_[*game_] && yaml_[*game_][option_name]) {
-    yaml_[*game_].remove(option_name);
+  if (entries_.empty()) {
+    writer.WriteDocument(YAML::Node(YAML::NodeType::Map));
+    return writer.Release();
   }
 
-  if (yaml_[*game_].IsMap() && yaml_[*game_].size() == 0) {
-    yaml_.remove(*game_);
+  for (const Entry& entry : entries_) {
+    writer.WriteKey(entry.key, 0);
+
+    if (entry.raw) {
+      writer.WriteNodeValue(*entry.raw, 0);
+    } else if (entry.key == "name") {
+      writer.WriteScalarValue(name_);
+    } else if (entry.key == "description") {
+      writer.WriteScalarValue(description_);
+    } else if (entry.key == "game") {
+      writer.WriteScalarValue(*game_);
+    } else if (game_entries_.empty()) {
+      writer.WriteRawValue("{}");
+    } else {
+      const Game& game = game_definitions_->GetGame(*game_);
+      writer.BeginBlockValue();
+
+      for (const Entry& game_entry : game_entries_) {
+        writer.WriteKey(game_entry.key, 2);
+
+        if (game_entry.raw) {
+          writer.WriteNodeValue(*game_entry.raw, 2);
+        } else {
+          WriteOptionValue(writer, game, game.GetOption(game_entry.key),
+                           ToOptionValue(options_.at(game_entry.key)), 4);
+        }
+      }
+    }
   }
-}
 
-void World::ClearOptions() {
-  dirty_ = true;
-  options_.clear();
+  return writer.Release();
 }
 
-void World::PopulateFromYaml() {
-  if (yaml_["game"] &&
-      !game_definitions_->HasGame(yaml_["game"].as<std::string>())) {
-    wxString error;
-    error << "Game \"";
-    error << yaml_["game"].as<std::string>();
-    error << "\" is not supported.";
-    throw std::invalid_argument(error.ToStdString());
+void World::PopulateFromYaml(const YAML::Node& root) {
+  TRACE_SPAN("World::PopulateFromYaml");
+
+  if (!root.IsMap() && !root.IsNull()) {
+    throw std::invalid_argument("The document should be a map.");
+  }
+
+  if (root["game"] &&
+      !game_definitions_->HasGame(root["game"].as<std::string>())) {
+    throw std::invalid_argument(
+        GetUnsupportedGameError(root["game"].as<std::string>()));
   }
 
   options_.clear();
+  unknown_options_.clear();
+  entries_.clear();
+  game_entries_.clear();
+
+  if (root["name"]) {
+    name_ = root["name"].as<std::string>();
+  }
 
-  if (yaml_["name"]) {
-    name_ = yaml_["name"].as<std::string>();
+  if (root["description"]) {
+    description_ = root["description"].as<std::string>();
   }
 
-  if (yaml_["description"]) {
-    description_ = yaml_["description"].as<std::string>();
+  if (root["game"]) {
+    game_ = root["game"].as<std::string>();
   }
 
-  if (yaml_["game"]) {
-    game_ = yaml_["game"].as<std::string>();
+  for (YAML::const_iterator it = root.begin(); it != root.end(); it++) {
+    std::string key = it->first.as<std::string>();
+
+    bool typed = false;
+    if (key == "name" || key == "description" || key == "game") {
+      typed = it->second.IsScalar();
+    } else if (game_ && key == *game_ && it->second.IsMap()) {
+      typed = true;
 
-    if (yaml_[*game_]) {
-      const YAML::Node& game_node = yaml_[*game_];
       const Game& game = game_definitions_->GetGame(*game_);
 
-      for (const OptionDefinition& option : game.GetOptions()) {
-        if (game_node[option.name]) {
-          OptionValue option_value;
-
-          if (option.type == kSelectOption || option.type == kRangeOption) {
-            // Choices and ranges can both be weighted.
-            if (game_node[option.name].IsScalar()) {
-              if (option.type == kSelectOption) {
-                option_value =
-                    OptionValueForChoiceValue(option, game_node[option.name]);
-              } else if (option.type == kRangeOption) {
-                option_value =
-                    OptionValueForRangeValue(option, game_node[option.name]);
-              }
-            } else if (game_node[option.name].IsMap()) {
-              option_value.random = true;
-
-              std::vector<wxString> errors;
-              for (YAML::const_iterator it = game_node[option.name].begin();
-                   it != game_node[option.name].end(); it++) {
-                OptionValue sub_option_value;
-                if (option.type == kSelectOption) {
-                  sub_option_value =
-                      OptionValueForChoiceValue(option, it->first);
-                } else if (option.type == kRangeOption) {
-                  sub_option_value =
-                      OptionValueForRangeValue(option, it->first);
-                }
-
-                if (sub_option_value.error) {
-                  errors.push_back(*sub_option_value.error);
-                }
-
-                try {
-                  sub_option_value.weight = it->second.as<int>();
-                } catch (const std::exception&) {
-                  wxString error;
-                  error << "Weight value \"";
-                  error << it->second.as<std::string>();
-                  error << "\" is not numeric.";
-
-                  errors.push_back(error);
-                }
-
-                if (sub_option_value.weight > 0) {
-                  option_value.weighting.push_back(std::move(sub_option_value));
-                }
-              }
-
-              if (option_value.weighting.size() == 1) {
-                OptionValue sub_option_value = option_value.weighting.front();
-                option_value = sub_option_value;
-              }
-
-              if (!errors.empty()) {
-                option_value.error = implode(errors).ToStdString();
-              }
-            }
-          } else if (option.type == kSetOption) {
-            const DoubleMap<std::string>& option_set =
-                GetOptionSetElements(game, option.name);
-            option_value.set_values.resize(option_set.size());
-
-            if (game_node[option.name].IsSequence()) {
-              std::vector<wxString> errors;
-
-              for (const YAML::Node& set_value : game_node[option.name]) {
-                std::string str_val = set_value.as<std::string>();
-                if (option_set.HasValue(str_val)) {
-                  option_value.set_values[option_set.GetId(str_val)] = true;
-                } else {
-                  wxString msg;
-                  msg << "Invalid value \"";
-                  msg << str_val;
-                  msg << "\".";
-
-                  errors.push_back(msg);
-                }
-              }
-
-              if (!errors.empty()) {
-                option_value.error = implode(errors).ToStdString();
-              }
-            } else {
-              option_value.error = "Option value should be a list.";
+      // Walk the section once, looking each key up in the game's index.
+      for (YAML::const_iterator option_it = it->second.begin();
+           option_it != it->second.end(); option_it++) {
+        std::string option_name = option_it->first.as<std::string>();
+
+        const OptionDefinition* option = game.FindOption(option_name);
+        if (!option) {
+          unknown_options_.push_back(option_name);
+          game_entries_.push_back({std::move(option_name), option_it->second});
+          continue;
+        }
+
+        OptionValue option_value =
+            OptionValueForNode(game, *option, option_it->second);
+        if (HasTypedForm(*option) && option_value.errors.empty()) {
+          game_entries_.push_back({option_name});
+        } else {
+          game_entries_.push_back({option_name, option_it->second});
+        }
+
+        options_[option_name] = ToCompactOptionValue(std::move(option_value));
+      }
+    }
+
+    if (typed) {
+      entries_.push_back({std::move(key)});
+    } else {
+      entries_.push_back({std::move(key), it->second});
+    }
+  }
+}
+
+bool World::UpdateFromYaml(
+    std::string_view text,
+    const std::vector<std::tuple<int, int>>& touched_lines) {
+  if (!game_) {
+    return false;
+  }
+
+  auto game_section = FindEntry(entries_, *game_);
+  if (game_section == entries_.end() || game_section->raw) {
+    return false;
+  }
+
+  const Game& game = game_definitions_->GetGame(*game_);
+
+  auto is_touched = [&touched_lines](int first_line, int last_line) {
+    for (const auto& [touched_first, touched_last] : touched_lines) {
+      if (touched_first <= last_line && touched_last >= first_line) {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  // Diagnostics hold the line they were found on, which moves when lines are
+  // added or removed above them, so options with errors are parsed again
+  // even when they weren't edited. Few options have errors.
+  auto has_positioned_errors = [this](const std::string& option_name) {
+    auto option = options_.find(option_name);
+    if (option == options_.end()) {
+      return false;
+    }
+
+    return std::any_of(
+        option->second.errors->begin(), option->second.errors->end(),
+        [](const Diagnostic& diagnostic) { return diagnostic.line >= 0; });
+  };
+
+  std::vector<std::string_view> lines = SplitYamlLines(text);
+  std::optional<std::vector<YamlOutlineEntry>> top_level =
+      OutlineYamlMap(lines, 0, lines.size() - 1);
+  if (!top_level) {
+    return false;
+  }
+
+  // Work out and parse everything that changed before modifying the world, so
+  // that a failure leaves it untouched. Untouched entries are carried over as
+  // they are, in their new order.
+  std::set<std::string> top_level_keys;
+  std::vector<Entry> entries;
+  std::optional<std::string> new_name;
+  std::optional<std::string> new_description;
+  std::set<std::string> game_keys;
+  std::vector<Entry> game_entries;
+  std::map<std::string, OptionValue> option_changes;
+  std::vector<std::string> unknown_options;
+  bool found_game = false;
+
+  try {
+    for (const YamlOutlineEntry& entry : *top_level) {
+      if (!top_level_keys.insert(entry.key).second) {
+        return false;
+      }
+
+      if (entry.key == *game_) {
+        if (entry.inline_value ||
+            is_touched(entry.first_line, entry.first_line)) {
+          return false;
+        }
+
+        found_game = true;
+        entries.push_back({entry.key});
+
+        std::optional<std::vector<YamlOutlineEntry>> game_outline =
+            OutlineYamlMap(lines, entry.first_line + 1, entry.last_line);
+        if (!game_outline) {
+          return false;
+        }
+
+        for (const YamlOutlineEntry& game_entry : *game_outline) {
+          if (!game_keys.insert(game_entry.key).second) {
+            return false;
+          }
+
+          const OptionDefinition* option = game.FindOption(game_entry.key);
+          if (!option) {
+            unknown_options.push_back(game_entry.key);
+          }
+
+          if (!is_touched(game_entry.first_line, game_entry.last_line) &&
+              !has_positioned_errors(game_entry.key)) {
+            auto existing = FindEntry(game_entries_, game_entry.key);
+            if (existing == game_entries_.end()) {
+              return false;
             }
-          } else if (option.type == kDictOption) {
-            const DoubleMap<std::string>& option_set =
-                GetOptionSetElements(game, option.name);
-
-            if (game_node[option.name].IsMap()) {
-              std::vector<wxString> errors;
-
-              for (YAML::const_iterator it = game_node[option.name].begin();
-                   it != game_node[option.name].end(); it++) {
-                std::string str_val = it->first.as<std::string>();
-                int int_val = it->second.as<int>();
-
-                if (option_set.HasValue(str_val)) {
-                  option_value.dict_values[option_set.GetId(str_val)] = int_val;
-                } else {
-                  wxString msg;
-                  msg << "Invalid value \"";
-                  msg << str_val;
-                  msg << "\".";
-
-                  errors.push_back(msg);
-                }
-              }
-
-              if (!errors.empty()) {
-                option_value.error = implode(errors).ToStdString();
-              }
+
+            game_entries.push_back(*existing);
+            continue;
+          }
+
+          YAML::Node node = ParseOutlineEntry(lines, game_entry);
+          if (!node.IsDefined()) {
+            return false;
+          }
+
+          if (option) {
+            OptionValue option_value = OptionValueForNode(game, *option, node);
+            OffsetDiagnostics(option_value, game_entry.first_line);
+
+            if (HasTypedForm(*option) && option_value.errors.empty()) {
+              game_entries.push_back({game_entry.key});
             } else {
-              option_value.error = "Option value should be a map.";
+              game_entries.push_back({game_entry.key, node});
             }
+
+            option_changes[game_entry.key] = std::move(option_value);
+          } else {
+            game_entries.push_back({game_entry.key, node});
           }
+        }
+      } else if (is_touched(entry.first_line, entry.last_line)) {
+        if (entry.key == "game") {
+          return false;
+        }
 
-          options_[option.name] = std::move(option_value);
+        YAML::Node node = ParseOutlineEntry(lines, entry);
+        if (!node.IsDefined()) {
+          return false;
         }
+
+        if (entry.key == "name") {
+          new_name = node.as<std::string>();
+          entries.push_back({entry.key});
+        } else if (entry.key == "description") {
+          new_description = node.as<std::string>();
+          entries.push_back({entry.key});
+        } else {
+          entries.push_back({entry.key, node});
+        }
+      } else {
+        auto existing = FindEntry(entries_, entry.key);
+        if (existing == entries_.end()) {
+          return false;
+        }
+
+        entries.push_back(*existing);
       }
     }
+  } catch (const std::exception&) {
+    return false;
   }
+
+  if (!found_game || !top_level_keys.count("game")) {
+    return false;
+  }
+
+  // Apply the changes.
+  MarkChanged();
+
+  entries_ = std::move(entries);
+  game_entries_ = std::move(game_entries);
+
+  // Removing the name changes the tree's label just like editing it does.
+  // Edits to the game key, including removing it, take the full parse.
+  bool name_changed = new_name.has_value();
+  if (!top_level_keys.count("name") && !name_.empty()) {
+    name_.clear();
+    name_changed = true;
+  }
+
+  if (!top_level_keys.count("description")) {
+    description_.clear();
+  }
+
+  if (new_name) {
+    name_ = std::move(*new_name);
+  }
+
+  if (name_changed && meta_update_callback_) {
+    meta_update_callback_();
+  }
+
+  if (new_description) {
+    description_ = std::move(*new_description);
+  }
+
+  std::erase_if(options_, [&game_keys](const auto& option) {
+    return !game_keys.count(option.first);
+  });
+
+  for (auto& [option_name, option_value] : option_changes) {
+    options_[option_name] = ToCompactOptionValue(std::move(option_value));
+  }
+
+  unknown_options_ = std::move(unknown_options);
+
+  return true;
+}
+
+std::string OptionValueToYaml(const Game& game, const std::string& option_name,
+                              const OptionValue& option_value) {
+  YamlWriter writer;
+  writer.WriteKey(option_name, 0);
+  WriteOptionValue(writer, game, game.GetOption(option_name), option_value, 2);
+
+  return writer.Release();
+}
+
+OptionValue OptionValueFromYaml(const Game& game,
+                                const std::string& option_name,
+                                std::string_view text) {
+  StringViewIStream text_stream(text);
+  YAML::Node root = YAML::Load(text_stream);
+  if (!root.IsMap() || !root[option_name]) {
+    throw std::invalid_argument("Expected a value for \"" + option_name +
+                                "\".");
+  }
+
+  return OptionValueForNode(game, game.GetOption(option_name),
+                            root[option_name]);
 }
@@ -3,34 +3,109 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
 #include <optional>
+#include <ostream>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
 #include "game_definition.h"
+#include "yaml_source.h"
 
 class World {
  public:
   explicit World(const GameDefinitions* game_definitions)
-      : game_definitions_(game_definitions) {}
+      : game_definitions_(game_definitions) {
+    MarkChanged();
+  }
 
   void Load(const std::string& filename);
 
+  // Loads every world in a file, which may contain several "---"-separated
+  // documents. When it does, each world refers back to its document in the
+  // shared source, and is only parsed fully once EnsureLoaded is called; until
+  // then, just its name, game and description are read.
+  //
+  // A document that can't be listed, e.g. because its game is not supported,
+  // still gets a world, which keeps the error; see GetLoadError.
+  static std::vector<std::unique_ptr<World>> LoadAll(
+      const GameDefinitions* game_definitions, const std::string& filename);
+
+  // Parses a world that was loaded lazily by LoadAll. This must be called
+  // before the world's options are used or anything is changed. Errors are
+  // positioned in the whole file.
+  void EnsureLoaded();
+
+  bool IsLoaded() const { return loaded_; }
+
+  // Why LoadAll couldn't list the world. EnsureLoaded throws it again.
+  const std::optional<std::string>& GetLoadError() const {
+    return load_error_;
+  }
+
+  // The position of the world within its file, for files with several worlds.
+  std::optional<size_t> GetDocumentIndex() const;
+
+  // The line of the file that the world's text starts on. Diagnostics are
+  // positioned in the world's own text, which is what the YAML editor shows,
+  // so add this to position them in the file.
+  int GetFirstLine() const;
+
+  // Writes the file atomically and marks the world as saved.
   void Save(const std::string& filename);
 
+  // Marks the world as saved if it has not changed since the given generation,
+  // for saves that finished in the background.
+  void MarkSaved(uint64_t generation);
+
+  // Records that an editor holds changes that aren't in the world yet. This
+  // counts as a change, so that a save already under way doesn't mark the
+  // world as saved when it finishes.
+  void MarkPendingEdit();
+
   bool HasFilename() const { return filename_.has_value(); }
 
   const std::string& GetFilename() const { return *filename_; }
 
-  void SetFilename(const std::string& val) { filename_ = val; }
+  // Changing the filename detaches the world from any multi-world file it came
+  // from.
+  void SetFilename(const std::string& val);
+
+  // The text is parsed in place and does not need to outlive the call.
+  void FromYaml(std::string_view text);
 
-  void FromYaml(const std::string& text);
+  // Like FromYaml, but only re-parses the top-level entries and game options
+  // that overlap the given (inclusive, zero-indexed) line ranges, keeping
+  // everything else as-is. Falls back to a full parse when the edit cannot be
+  // isolated to individual entries.
+  void FromYaml(std::string_view text,
+                const std::vector<std::tuple<int, int>>& touched_lines);
+
+  void FromNode(YAML::Node node);
 
   std::string ToYaml() const;
 
+  // Like ToYaml, but the text is cached until the world next changes.
+  const std::string& GetYamlText() const;
+
+  // The same text, shared so that it can be handed to another thread. It
+  // remains valid, and unchanged, after the world changes.
+  std::shared_ptr<const std::string> GetYamlSnapshot() const;
+
+  // The text of the whole file the world is saved to. For a world that shares
+  // a file with others, this replaces just its own document, leaving the rest
+  // as last loaded or saved.
+  std::shared_ptr<const std::string> GetFileSnapshot();
+
+  // Streams the document straight into the output, for callers that have
+  // somewhere better to put it than a temporary string.
+  void WriteYaml(std::ostream& output) const;
+
   const std::string& GetName() const { return name_; }
 
   void SetName(std::string name);
@@ -49,7 +124,11 @@ class World {
 
   bool HasOption(const std::string& option_name) const;
 
-  const OptionValue& GetOption(const std::string& option_name) const;
+  // Values are stored compactly, so this builds a copy of the value.
+  OptionValue GetOption(const std::string& option_name) const;
+
+  const std::vector<Diagnostic>& GetOptionErrors(
+      const std::string& option_name) const;
 
   void SetOption(const std::string& option_name, OptionValue option_value);
 
@@ -57,12 +136,33 @@ class World {
 
   bool HasSetOptions() const { return !options_.empty(); }
 
+  // Returns the names of the options whose values could not be understood.
+  std::vector<std::string> GetInvalidOptions() const;
+
+  // Keys in the game's section that don't name any of its options. These are
+  // kept in the document, but otherwise ignored.
+  const std::vector<std::string>& GetUnknownOptions() const {
+    return unknown_options_;
+  }
+
+  // Replaces all of the world's options with the given ones, as a single
+  // change.
+  void ApplyOptions(const PresetOptions& options);
+
   void ClearOptions();
 
+  // An estimate of the memory the world uses, including its cached text, for
+  // the diagnostics panel.
+  size_t GetMemoryUsage() const;
+
   void SetMetaUpdateCallback(std::function<void()> callback) {
     meta_update_callback_ = callback;
   }
 
+  // Changes whenever the contents of the world change. Generations are never
+  // reused, even by other worlds.
+  uint64_t GetGeneration() const { return generation_; }
+
   bool IsDirty() const { return dirty_; }
 
   void SetDirty(bool v) {
@@ -74,21 +174,68 @@ class World {
   }
 
  private:
-  void PopulateFromYaml();
+  void MarkChanged();
+
+  // Adds or removes the game's section, depending on whether it has any
+  // entries. A section that isn't a map of options is left as it is.
+  void UpdateGameSection();
+
+  // Writes the document, taking the options from their typed values rather
+  // than going through yaml-cpp's emitter.
+  std::string BuildYamlText() const;
+
+  void PopulateFromYaml(const YAML::Node& root);
+
+  void LoadDocument(std::shared_ptr<YamlSource> source, size_t index);
+
+  bool UpdateFromYaml(std::string_view text,
+                      const std::vector<std::tuple<int, int>>& touched_lines);
+
+  // An entry of the document, in the order it is written. Entries that the
+  // world understands are written from its typed state and have no node;
+  // anything else (keys it doesn't know, and values it couldn't understand) is
+  // kept as written, so that it survives being saved.
+  struct Entry {
+    std::string key;
+    std::optional<YAML::Node> raw = std::nullopt;
+  };
 
   const GameDefinitions* game_definitions_;
 
   std::string name_;
   std::optional<std::string> game_;
   std::string description_;
-  std::map<std::string, OptionValue> options_;
+  std::map<std::string, CompactOptionValue> options_;
+  std::vector<std::string> unknown_options_;
+
+  std::vector<Entry> entries_;
+  std::vector<Entry> game_entries_;  // the game's section
 
   std::optional<std::string> filename_;
   bool dirty_ = false;
 
-  YAML::Node yaml_;
+  uint64_t generation_ = 0;
+
+  std::shared_ptr<YamlSource> source_;
+  size_t source_index_ = 0;
+  bool loaded_ = true;
+  std::optional<std::string> load_error_;
+
+  mutable std::shared_ptr<const std::string> yaml_text_;
+  mutable uint64_t yaml_text_generation_ = 0;
 
   std::function<void()> meta_update_callback_;
 };
 
+// An option's value as a one-entry YAML map, as it would appear in the game's
+// section. The option must be a select, range, set or dict option.
+std::string OptionValueToYaml(const Game& game, const std::string& option_name,
+                              const OptionValue& option_value);
+
+// The reverse of OptionValueToYaml. Throws std::invalid_argument if the text
+// isn't a map with the option in it.
+OptionValue OptionValueFromYaml(const Game& game,
+                                const std::string& option_name,
+                                std::string_view text);
+
 #endif /* end of include guard: WORLD_H_3EAD88F6 */
@@ -1,5 +1,8 @@
 #include "world_window.h"
 
+#include <iostream>
+
+#include "session_script.h"
 #include "wizard_editor.h"
 #include "yaml_editor.h"
 
@@ -10,7 +13,7 @@ WorldWindow::WorldWindow(wxWindow* parent,
   Bind(wxEVT_NOTEBOOK_PAGE_CHANGED, &WorldWindow::OnPageChanged, this);
 
   wizard_editor_ = CreateWizardEditor(this, game_definitions_);
-  yaml_editor_ = new YamlEditor(this);
+  yaml_editor_ = new YamlEditor(this, game_definitions_);
 
   AddPage(wizard_editor_, "Wizard", true);
   AddPage(yaml_editor_, "YAML", false);
@@ -49,6 +52,10 @@ void WorldWindow::UnloadWorld() {
   }
 }
 
+void WorldWindow::ForgetWorld(const World* world) {
+  yaml_editor_->ForgetWorld(world);
+}
+
 void WorldWindow::OnPageChanging(wxBookCtrlEvent& event) {
   if (!world_) {
     return;
@@ -61,6 +68,14 @@ void WorldWindow::OnPageChanging(wxBookCtrlEvent& event) {
       wxString msg;
       msg << "Could not process YAML.\n\n";
       msg << ex.what();
+
+      if (!interactive_) {
+        std::cerr << "Invalid YAML: " << msg.ToStdString() << std::endl;
+        event.Veto();
+
+        return;
+      }
+
       msg << "\n\nWould you like to discard your changes?";
 
       if (wxMessageBox(msg, "Invalid YAML", wxYES_NO) == wxNO) {
@@ -75,6 +90,13 @@ void WorldWindow::OnPageChanged(wxBookCtrlEvent& event) {
     return;
   }
 
+  if (IsRecordingSession()) {
+    SessionStep step;
+    step.type = SessionStepType::kSwitchTab;
+    step.index = GetSelection();
+    RecordSessionStep(step);
+  }
+
   if (GetSelection() == 0) {
     wizard_editor_->Reload();
   } else if (GetSelection() == 1) {
@@ -86,3 +108,7 @@ void WorldWindow::SetMessageCallback(
     std::function<void(const wxString&, const wxString&)> callback) {
   wizard_editor_->SetMessageCallback(std::move(callback));
 }
+
+std::vector<WindowPoolStats> WorldWindow::GetWindowPoolStats() const {
+  return wizard_editor_->GetWindowPoolStats();
+}
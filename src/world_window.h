@@ -10,6 +10,9 @@
 #include <wx/notebook.h>
 
 #include <functional>
+#include <vector>
+
+#include "window_pool.h"
 
 class GameDefinitions;
 class WizardEditor;
@@ -26,9 +29,19 @@ class WorldWindow : public wxNotebook {
 
   void UnloadWorld();
 
+  void ForgetWorld(const World* world);
+
   void SetMessageCallback(
       std::function<void(const wxString&, const wxString&)> callback);
 
+  // When not interactive, YAML that can't be processed when switching tabs is
+  // reported on stderr and kept, instead of asking whether to discard it.
+  void SetInteractive(bool interactive) { interactive_ = interactive; }
+
+  WizardEditor* GetWizardEditor() const { return wizard_editor_; }
+
+  std::vector<WindowPoolStats> GetWindowPoolStats() const;
+
  private:
   void OnPageChanging(wxBookCtrlEvent& event);
   void OnPageChanged(wxBookCtrlEvent& event);
@@ -39,6 +52,7 @@ class WorldWindow : public wxNotebook {
   YamlEditor* yaml_editor_;
 
   World* world_ = nullptr;
+  bool interactive_ = true;
 };
 
 #endif /* end of include guard: WORLD_WINDOW_H_5F182828 */
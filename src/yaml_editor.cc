@@ -2,9 +2,36 @@
 
 #include <wx/stc/stc.h>
 
+#include <algorithm>
+#include <string_view>
+
+#include "game_definition.h"
 #include "world.h"
+#include "yaml_outline.h"
+
+namespace {
+
+constexpr int kValidationDelayMs = 300;
+constexpr size_t kMaxCompletions = 100;
+
+// The completion mode for the line being edited.
+constexpr char kKeyMode = 'k';
+constexpr char kValueMode = 'v';
+constexpr char kSequenceMode = 's';
 
-YamlEditor::YamlEditor(wxWindow* parent) : wxPanel(parent, wxID_ANY) {
+constexpr int kErrorIndicator = wxSTC_INDIC_CONTAINER;
+constexpr int kWarningIndicator = wxSTC_INDIC_CONTAINER + 1;
+constexpr int kErrorMarker = 1;
+constexpr int kWarningMarker = 2;
+constexpr int kMarkerMargin = 1;
+
+}  // namespace
+
+YamlEditor::YamlEditor(wxWindow* parent,
+                       const GameDefinitions* game_definitions)
+    : wxPanel(parent, wxID_ANY),
+      game_definitions_(game_definitions),
+      validation_timer_(this) {
   editor_ = new wxStyledTextCtrl(this, wxID_ANY);
   editor_->SetLexer(wxSTC_LEX_YAML);
 
@@ -35,39 +62,434 @@ YamlEditor::YamlEditor(wxWindow* parent) : wxPanel(parent, wxID_ANY) {
 
   editor_->SetCaretForeground(wxColour(204, 204, 204));
 
+  editor_->SetMarginType(kMarkerMargin, wxSTC_MARGIN_SYMBOL);
+  editor_->SetMarginWidth(kMarkerMargin, 16);
+  editor_->SetMarginMask(kMarkerMargin,
+                         (1 << kErrorMarker) | (1 << kWarningMarker));
+  editor_->MarkerDefine(kErrorMarker, wxSTC_MARK_CIRCLE,
+                        wxColour(242, 119, 122), wxColour(242, 119, 122));
+  editor_->MarkerDefine(kWarningMarker, wxSTC_MARK_CIRCLE,
+                        wxColour(255, 204, 102), wxColour(255, 204, 102));
+
+  editor_->IndicatorSetStyle(kErrorIndicator, wxSTC_INDIC_SQUIGGLE);
+  editor_->IndicatorSetForeground(kErrorIndicator, wxColour(242, 119, 122));
+  editor_->IndicatorSetStyle(kWarningIndicator, wxSTC_INDIC_SQUIGGLE);
+  editor_->IndicatorSetForeground(kWarningIndicator, wxColour(255, 204, 102));
+
+  editor_->SetMouseDwellTime(500);
+  editor_->Bind(wxEVT_STC_DWELLSTART, &YamlEditor::OnDwellStart, this);
+  editor_->Bind(wxEVT_STC_DWELLEND, &YamlEditor::OnDwellEnd, this);
+
+  editor_->AutoCompSetIgnoreCase(true);
+  editor_->AutoCompSetAutoHide(false);
+  editor_->AutoCompSetOrder(wxSTC_ORDER_CUSTOM);
+  editor_->AutoCompSetSeparator('\n');
+  editor_->AutoCompSetTypeSeparator('\x1f');
+  editor_->AutoCompSetMaxHeight(10);
+  editor_->Bind(wxEVT_STC_CHARADDED, &YamlEditor::OnCharAdded, this);
+  editor_->Bind(wxEVT_KEY_DOWN, &YamlEditor::OnKeyDown, this);
+
   editor_->SetModEventMask(wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT |
                            wxSTC_PERFORMED_USER | wxSTC_PERFORMED_UNDO |
                            wxSTC_PERFORMED_REDO);
   editor_->Bind(wxEVT_STC_CHANGE, &YamlEditor::OnTextEdited, this);
+  editor_->Bind(wxEVT_STC_MODIFIED, &YamlEditor::OnTextModified, this);
 
   wxBoxSizer* sizer = new wxBoxSizer(wxVERTICAL);
   sizer->Add(editor_, wxSizerFlags().Proportion(1).Expand());
   SetSizer(sizer);
+
+  Bind(wxEVT_TIMER, &YamlEditor::OnValidationTimer, this);
+
+  std::vector<std::string> game_names(
+      game_definitions_->GetAllGames().begin(),
+      game_definitions_->GetAllGames().end());
+  game_name_completions_ = CompletionIndex(game_names);
+
+  std::vector<std::string> top_level_keys = {"name", "description", "game",
+                                             "requires"};
+  top_level_keys.insert(top_level_keys.end(), game_names.begin(),
+                        game_names.end());
+  top_level_completions_ = CompletionIndex(std::move(top_level_keys));
+
+  // The callback runs on the validator's thread, so the results are handed
+  // back to the UI thread. Stale results are discarded in ShowProblems.
+  validator_ = std::make_unique<YamlValidator>(
+      game_definitions_,
+      [this](uint64_t generation, std::vector<YamlProblem> problems) {
+        CallAfter([this, generation, problems = std::move(problems)] {
+          ShowProblems(generation, problems);
+        });
+      });
 }
 
 void YamlEditor::LoadWorld(World* world) {
+  if (world == world_ && !dirty_ &&
+      shown_generation_ == world_->GetGeneration()) {
+    // The editor already shows this exact document, so there is nothing to
+    // re-emit and the scroll position can be left alone.
+    return;
+  }
+
+  if (world_ != nullptr) {
+    SaveViewState();
+  }
+
   world_ = world;
   dirty_ = false;
 
+  // The world caches its serialized text, so this only re-emits the document
+  // if it changed since it was last shown.
+  const std::string& text = world_->GetYamlText();
+
   ignore_edit_ = true;
-  editor_->SetText(world_->ToYaml());
+  editor_->ClearAll();
+  editor_->AppendTextRaw(text.data(), text.size());
+  editor_->EmptyUndoBuffer();
   ignore_edit_ = false;
+
+  shown_generation_ = world_->GetGeneration();
+  touched_lines_.clear();
+
+  auto view_state = view_states_.find(world_);
+  if (view_state != view_states_.end()) {
+    editor_->SetSelection(view_state->second.anchor,
+                          view_state->second.current_pos);
+    editor_->SetFirstVisibleLine(view_state->second.first_visible_line);
+  } else {
+    editor_->GotoPos(0);
+  }
+
+  validator_->Cancel();
+  ClearProblems();
+  validation_timer_.StartOnce(kValidationDelayMs);
+}
+
+void YamlEditor::ForgetWorld(const World* world) {
+  view_states_.erase(world);
+
+  if (world_ == world) {
+    world_ = nullptr;
+    shown_generation_ = 0;
+  }
 }
 
 void YamlEditor::SaveWorld() {
   if (dirty_) {
-    world_->FromYaml(editor_->GetText().ToStdString());
+    // Parse straight out of the editor's buffer rather than copying it into a
+    // wxString and then a std::string.
+    world_->FromYaml(std::string_view(editor_->GetCharacterPointer(),
+                                      editor_->GetLength()),
+                     touched_lines_);
     dirty_ = false;
+    touched_lines_.clear();
+
+    // The editor's text is the source of what the world now contains, so it
+    // doesn't need to be replaced by a re-emitted copy unless something else
+    // changes the world.
+    shown_generation_ = world_->GetGeneration();
   }
 }
 
+void YamlEditor::SaveViewState() {
+  ViewState& view_state = view_states_[world_];
+  view_state.first_visible_line = editor_->GetFirstVisibleLine();
+  view_state.current_pos = editor_->GetCurrentPos();
+  view_state.anchor = editor_->GetAnchor();
+}
+
 void YamlEditor::OnTextEdited(wxStyledTextEvent& event) {
   if (ignore_edit_) {
     return;
   }
 
   dirty_ = true;
-  if (!world_->IsDirty()) {
-    world_->SetDirty(true);
+  world_->MarkPendingEdit();
+
+  // Any running validation is now out of date. Restarting the timer debounces
+  // further keystrokes.
+  validator_->Cancel();
+  validation_timer_.StartOnce(kValidationDelayMs);
+}
+
+void YamlEditor::OnTextModified(wxStyledTextEvent& event) {
+  event.Skip();
+
+  if (ignore_edit_ || !(event.GetModificationType() &
+                        (wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT))) {
+    return;
+  }
+
+  int line = editor_->LineFromPosition(event.GetPosition());
+  int lines_added = event.GetLinesAdded();
+
+  // Keep previously recorded ranges pointing at the same text.
+  for (auto& [first_line, last_line] : touched_lines_) {
+    if (first_line > line) {
+      first_line = std::max(line, first_line + lines_added);
+    }
+    if (last_line > line) {
+      last_line = std::max(line, last_line + lines_added);
+    }
+  }
+
+  int last_touched = line + std::max(lines_added, 0);
+  if (!touched_lines_.empty()) {
+    auto& [first_line, last_line] = touched_lines_.back();
+    if (line >= first_line - 1 && line <= last_line + 1) {
+      first_line = std::min(first_line, line);
+      last_line = std::max(last_line, last_touched);
+      return;
+    }
+  }
+
+  touched_lines_.emplace_back(line, last_touched);
+}
+
+void YamlEditor::OnValidationTimer(wxTimerEvent& event) {
+  // The validator needs its own snapshot, but it can be copied directly out of
+  // the editor's buffer.
+  validator_->Submit(
+      std::string(editor_->GetCharacterPointer(), editor_->GetLength()));
+}
+
+void YamlEditor::OnDwellStart(wxStyledTextEvent& event) {
+  if (event.GetPosition() < 0) {
+    return;
+  }
+
+  int line = editor_->LineFromPosition(event.GetPosition());
+  for (const YamlProblem& problem : problems_) {
+    if (problem.line == line) {
+      editor_->CallTipShow(event.GetPosition(),
+                           wxString::FromUTF8(problem.message));
+      return;
+    }
+  }
+}
+
+void YamlEditor::OnDwellEnd(wxStyledTextEvent& event) {
+  if (editor_->CallTipActive()) {
+    editor_->CallTipCancel();
+  }
+}
+
+void YamlEditor::ShowProblems(uint64_t generation,
+                              std::vector<YamlProblem> problems) {
+  if (generation != validator_->GetGeneration()) {
+    return;
+  }
+
+  ClearProblems();
+
+  problems_ = std::move(problems);
+
+  for (const YamlProblem& problem : problems_) {
+    if (problem.line >= editor_->GetLineCount()) {
+      continue;
+    }
+
+    int line_start = editor_->PositionFromLine(problem.line);
+    int line_end = editor_->GetLineEndPosition(problem.line);
+
+    int start = std::min(line_start + problem.column, line_end);
+    int end = problem.length > 0 ? std::min(start + problem.length, line_end)
+                                 : line_end;
+    if (start == end && start > line_start) {
+      start--;
+    }
+
+    editor_->SetIndicatorCurrent(problem.warning ? kWarningIndicator
+                                                 : kErrorIndicator);
+    editor_->IndicatorFillRange(start, end - start);
+    editor_->MarkerAdd(problem.line,
+                       problem.warning ? kWarningMarker : kErrorMarker);
+  }
+}
+
+void YamlEditor::ClearProblems() {
+  problems_.clear();
+
+  for (int indicator : {kErrorIndicator, kWarningIndicator}) {
+    editor_->SetIndicatorCurrent(indicator);
+    editor_->IndicatorClearRange(0, editor_->GetLength());
+  }
+
+  editor_->MarkerDeleteAll(kErrorMarker);
+  editor_->MarkerDeleteAll(kWarningMarker);
+}
+
+void YamlEditor::OnCharAdded(wxStyledTextEvent& event) {
+  int key = event.GetKey();
+  if (key == '\n' || key == '\r' || key == ':' || key == '#') {
+    if (editor_->AutoCompActive()) {
+      editor_->AutoCompCancel();
+    }
+
+    return;
+  }
+
+  ShowCompletions(/*explicit_request=*/false);
+}
+
+void YamlEditor::OnKeyDown(wxKeyEvent& event) {
+  if (event.GetKeyCode() == WXK_SPACE && event.ControlDown()) {
+    ShowCompletions(/*explicit_request=*/true);
+    return;
+  }
+
+  event.Skip();
+}
+
+void YamlEditor::ShowCompletions(bool explicit_request) {
+  int pos = editor_->GetCurrentPos();
+  int line = editor_->LineFromPosition(pos);
+  int line_start = editor_->PositionFromLine(line);
+
+  wxCharBuffer line_buffer = editor_->GetTextRangeRaw(line_start, pos);
+  std::string_view text_before(line_buffer.data(), line_buffer.length());
+
+  int indentation = GetIndentation(text_before);
+  std::string_view content = text_before.substr(indentation);
+
+  char mode;
+  std::string mode_key;
+  std::string_view word;
+  if (content.starts_with("- ")) {
+    mode = kSequenceMode;
+    word = content.substr(2);
+  } else if (size_t colon = content.find(": ");
+             colon != std::string_view::npos) {
+    bool has_value = false;
+    std::optional<std::string> parsed_key =
+        ParseYamlMapKey(content, &has_value);
+    if (!parsed_key) {
+      return;
+    }
+
+    mode = kValueMode;
+    mode_key = std::move(*parsed_key);
+    word = content.substr(colon + 2);
+  } else {
+    mode = kKeyMode;
+    word = content;
+  }
+
+  size_t word_start = word.find_first_not_of(" \"'");
+  word = word_start == std::string_view::npos ? std::string_view()
+                                               : word.substr(word_start);
+
+  const CompletionIndex* index =
+      (word.empty() && !explicit_request)
+          ? nullptr
+          : GetCompletionIndex(line, indentation, mode_key, mode);
+  if (index == nullptr) {
+    if (editor_->AutoCompActive()) {
+      editor_->AutoCompCancel();
+    }
+
+    return;
+  }
+
+  std::vector<std::string_view> completions =
+      index->Find(word, kMaxCompletions);
+  if (completions.empty()) {
+    if (editor_->AutoCompActive()) {
+      editor_->AutoCompCancel();
+    }
+
+    return;
+  }
+
+  std::string list;
+  for (std::string_view completion : completions) {
+    if (!list.empty()) {
+      list.push_back('\n');
+    }
+
+    list.append(completion);
+  }
+
+  editor_->AutoCompShow(word.size(), wxString::FromUTF8(list));
+}
+
+const CompletionIndex* YamlEditor::GetCompletionIndex(
+    int line, int indentation, const std::string& mode_key, char mode) {
+  if (indentation == 0) {
+    if (mode == kKeyMode) {
+      return &top_level_completions_;
+    } else if (mode == kValueMode && mode_key == "game") {
+      return &game_name_completions_;
+    }
+
+    return nullptr;
+  }
+
+  // Find the keys of the parent and grandparent mappings.
+  std::vector<std::string> ancestors;
+  int ancestor_indentation = indentation;
+  for (int i = line - 1; i >= 0 && ancestor_indentation > 0; i--) {
+    wxCharBuffer line_buffer = editor_->GetLineRaw(i);
+    std::string_view line_text(line_buffer.data(), line_buffer.length());
+    if (IsBlankOrComment(line_text)) {
+      continue;
+    }
+
+    int line_indentation = GetIndentation(line_text);
+    if (line_indentation >= ancestor_indentation) {
+      continue;
+    }
+
+    bool has_value = false;
+    std::optional<std::string> key =
+        ParseYamlMapKey(line_text.substr(line_indentation), &has_value);
+    if (!key || has_value) {
+      return nullptr;
+    }
+
+    ancestors.push_back(std::move(*key));
+    ancestor_indentation = line_indentation;
   }
+
+  if (ancestor_indentation != 0 || ancestors.empty() ||
+      !game_definitions_->HasGame(ancestors.back())) {
+    return nullptr;
+  }
+
+  const GameCompletions& completions = GetGameCompletions(ancestors.back());
+  if (ancestors.size() == 1) {
+    if (mode == kKeyMode) {
+      return &completions.GetOptionNames();
+    } else if (mode == kValueMode) {
+      return completions.GetOptionValues(mode_key);
+    }
+  } else if (ancestors.size() == 2) {
+    const std::string& option_name = ancestors.front();
+
+    if (mode == kSequenceMode) {
+      return completions.GetSetValues(option_name);
+    } else if (mode == kKeyMode) {
+      // Dict options are keyed by items, and weighted options by values.
+      if (const CompletionIndex* set_values =
+              completions.GetSetValues(option_name)) {
+        return set_values;
+      }
+
+      return completions.GetOptionValues(option_name);
+    }
+  }
+
+  return nullptr;
+}
+
+const GameCompletions& YamlEditor::GetGameCompletions(const std::string& game) {
+  auto it = game_completions_by_name_.find(game);
+  if (it == game_completions_by_name_.end()) {
+    it = game_completions_by_name_
+             .emplace(game, std::make_unique<GameCompletions>(
+                                game_definitions_->GetGame(game)))
+             .first;
+  }
+
+  return *it->second;
 }
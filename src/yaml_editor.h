@@ -7,26 +7,80 @@
 #include <wx/wx.h>
 #endif
 
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "completion_index.h"
+#include "yaml_validator.h"
+
+class GameDefinitions;
 class wxStyledTextCtrl;
 class wxStyledTextEvent;
 class World;
 
 class YamlEditor : public wxPanel {
  public:
-  explicit YamlEditor(wxWindow* parent);
+  YamlEditor(wxWindow* parent, const GameDefinitions* game_definitions);
 
   void LoadWorld(World* world);
 
   void SaveWorld();
 
+  // Drops any state kept for a world that is being closed.
+  void ForgetWorld(const World* world);
+
  private:
   void OnTextEdited(wxStyledTextEvent& event);
+  void OnTextModified(wxStyledTextEvent& event);
+  void OnValidationTimer(wxTimerEvent& event);
+  void OnDwellStart(wxStyledTextEvent& event);
+  void OnDwellEnd(wxStyledTextEvent& event);
+  void OnCharAdded(wxStyledTextEvent& event);
+  void OnKeyDown(wxKeyEvent& event);
+
+  void ShowCompletions(bool explicit_request);
+  const CompletionIndex* GetCompletionIndex(int line, int indentation,
+                                            const std::string& mode_key,
+                                            char mode);
+  const GameCompletions& GetGameCompletions(const std::string& game);
+
+  void SaveViewState();
+
+  void ShowProblems(uint64_t generation, std::vector<YamlProblem> problems);
+  void ClearProblems();
+
+  const GameDefinitions* game_definitions_;
 
   wxStyledTextCtrl* editor_;
-  World* world_;
+  World* world_ = nullptr;
+  uint64_t shown_generation_ = 0;
 
   bool dirty_ = false;
   bool ignore_edit_ = false;
+
+  // Line ranges (inclusive) edited since the world was loaded, in terms of
+  // the current document.
+  std::vector<std::tuple<int, int>> touched_lines_;
+
+  wxTimer validation_timer_;
+  std::unique_ptr<YamlValidator> validator_;
+  std::vector<YamlProblem> problems_;
+
+  struct ViewState {
+    int first_visible_line = 0;
+    int current_pos = 0;
+    int anchor = 0;
+  };
+
+  std::map<const World*, ViewState> view_states_;
+
+  CompletionIndex top_level_completions_;
+  CompletionIndex game_name_completions_;
+  std::map<std::string, std::unique_ptr<GameCompletions>>
+      game_completions_by_name_;
 };
 
 #endif /* end of include guard: YAML_EDITOR_H_BB0F5830 */
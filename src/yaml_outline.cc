@@ -0,0 +1,174 @@
+#include "yaml_outline.h"
+
+bool IsBlankOrComment(std::string_view line) {
+  size_t first = line.find_first_not_of(" \t\r\n");
+  return first == std::string_view::npos || line[first] == '#';
+}
+
+int GetIndentation(std::string_view line) {
+  size_t first = line.find_first_not_of(' ');
+  return first == std::string_view::npos ? line.size() : first;
+}
+
+std::optional<std::string> ParseYamlMapKey(std::string_view line,
+                                           bool* has_value) {
+  if (line.empty()) {
+    return std::nullopt;
+  }
+
+  size_t key_end;
+  std::string key;
+
+  if (line.front() == '"' || line.front() == '\'') {
+    size_t close = line.find(line.front(), 1);
+    if (close == std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    key = line.substr(1, close - 1);
+    key_end = close + 1;
+
+    if (key_end >= line.size() || line[key_end] != ':') {
+      return std::nullopt;
+    }
+  } else {
+    if (line.front() == '-' || line.front() == '?' || line.front() == '[' ||
+        line.front() == '{' || line.front() == '&' || line.front() == '*' ||
+        line.front() == '!') {
+      return std::nullopt;
+    }
+
+    key_end = line.find(": ");
+    if (key_end == std::string_view::npos) {
+      key_end = line.find(":\t");
+    }
+    if (key_end == std::string_view::npos) {
+      if (line.back() != ':') {
+        return std::nullopt;
+      }
+
+      key_end = line.size() - 1;
+    }
+
+    size_t last = line.find_last_not_of(" \t", key_end - 1);
+    if (key_end == 0 || last == std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    key = line.substr(0, last + 1);
+  }
+
+  std::string_view rest = line.substr(key_end + 1);
+  size_t value_start = rest.find_first_not_of(" \t");
+  *has_value =
+      value_start != std::string_view::npos && rest[value_start] != '#';
+
+  return key;
+}
+
+std::vector<std::string_view> SplitYamlLines(std::string_view text) {
+  std::vector<std::string_view> lines;
+
+  for (;;) {
+    size_t newline = text.find('\n');
+    std::string_view line = text.substr(0, newline);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+
+    lines.push_back(line);
+
+    if (newline == std::string_view::npos) {
+      break;
+    }
+
+    text.remove_prefix(newline + 1);
+  }
+
+  return lines;
+}
+
+std::optional<std::vector<YamlOutlineEntry>> OutlineYamlMap(
+    const std::vector<std::string_view>& lines, int first_line,
+    int last_line) {
+  std::vector<YamlOutlineEntry> entries;
+  std::optional<int> indentation;
+
+  for (int i = first_line; i <= last_line; i++) {
+    std::string_view line = lines.at(i);
+    if (IsBlankOrComment(line)) {
+      if (!entries.empty()) {
+        entries.back().last_line = i;
+      }
+
+      continue;
+    }
+
+    if (line.find('\t') < line.find_first_not_of(" \t")) {
+      // Tabs are not valid indentation.
+      return std::nullopt;
+    }
+
+    int line_indentation = GetIndentation(line);
+    if (!indentation) {
+      if (line == "---" || line.starts_with("--- ") || line == "...") {
+        if (i == 0) {
+          continue;
+        }
+
+        return std::nullopt;
+      }
+
+      indentation = line_indentation;
+    }
+
+    if (line_indentation > *indentation) {
+      if (entries.empty() || entries.back().inline_value) {
+        // Continuation lines of an inline value, such as a multi-line flow
+        // collection or plain scalar, are not handled.
+        return std::nullopt;
+      }
+
+      entries.back().last_line = i;
+      continue;
+    } else if (line_indentation < *indentation) {
+      return std::nullopt;
+    }
+
+    bool has_value = false;
+    std::optional<std::string> key =
+        ParseYamlMapKey(line.substr(line_indentation), &has_value);
+    if (!key) {
+      return std::nullopt;
+    }
+
+    YamlOutlineEntry entry;
+    entry.key = std::move(*key);
+    entry.first_line = i;
+    entry.last_line = i;
+    entry.inline_value = has_value;
+
+    // A block scalar indicator means the value continues on the next lines.
+    if (has_value && (line.ends_with("|") || line.ends_with(">") ||
+                      line.ends_with("|-") || line.ends_with(">-") ||
+                      line.ends_with("|+") || line.ends_with(">+"))) {
+      entry.inline_value = false;
+    }
+
+    entries.push_back(std::move(entry));
+  }
+
+  return entries;
+}
+
+std::string ExtractYamlLines(const std::vector<std::string_view>& lines,
+                             int first_line, int last_line) {
+  std::string result;
+
+  for (int i = first_line; i <= last_line; i++) {
+    result.append(lines.at(i));
+    result.push_back('\n');
+  }
+
+  return result;
+}
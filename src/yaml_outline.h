@@ -0,0 +1,41 @@
+#ifndef YAML_OUTLINE_H_4A9C2E71
+#define YAML_OUTLINE_H_4A9C2E71
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct YamlOutlineEntry {
+  std::string key;
+  int first_line = 0;  // the line containing the key
+  int last_line = 0;   // inclusive; includes trailing comments and blank lines
+  bool inline_value = false;  // true if the value starts on the key's line
+};
+
+bool IsBlankOrComment(std::string_view line);
+
+// The number of leading spaces, or the line's length if it is all spaces.
+int GetIndentation(std::string_view line);
+
+// Parses the key of a "key: value" or "key:" line (without its indentation).
+// has_value is set if something other than a comment follows the colon.
+std::optional<std::string> ParseYamlMapKey(std::string_view line,
+                                           bool* has_value);
+
+// Splits a document into lines without copying it.
+std::vector<std::string_view> SplitYamlLines(std::string_view text);
+
+// Finds the keys of the block mapping spanning the given (inclusive) line
+// range, without parsing the values. This only understands simple block
+// mappings; std::nullopt is returned for anything else (flow collections,
+// sequences, complex keys, multiple documents) so that callers can fall back
+// to a full parse.
+std::optional<std::vector<YamlOutlineEntry>> OutlineYamlMap(
+    const std::vector<std::string_view>& lines, int first_line, int last_line);
+
+// Returns the given lines joined into a standalone document.
+std::string ExtractYamlLines(const std::vector<std::string_view>& lines,
+                             int first_line, int last_line);
+
+#endif /* end of include guard: YAML_OUTLINE_H_4A9C2E71 */
@@ -0,0 +1,137 @@
+#include "yaml_source.h"
+
+#include <algorithm>
+
+namespace {
+
+// Returns how much of the line belongs to a "---" document separator (the
+// marker, and the rest of the line if it is blank or a comment), or zero if
+// the line does not start a document.
+size_t GetSeparatorLength(std::string_view line) {
+  if (!line.starts_with("---")) {
+    return 0;
+  }
+
+  if (line.size() > 3 && line[3] != ' ' && line[3] != '\t' &&
+      line[3] != '\r' && line[3] != '\n') {
+    return 0;
+  }
+
+  size_t content = line.find_first_not_of(" \t\r\n", 3);
+  if (content == std::string_view::npos || line[content] == '#') {
+    return line.size();
+  }
+
+  return content;
+}
+
+// Whether the text holds anything other than blank lines, comments,
+// directives and document end markers.
+bool HasContent(std::string_view text) {
+  while (!text.empty()) {
+    size_t newline = text.find('\n');
+    std::string_view line = text.substr(0, newline);
+
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first != std::string_view::npos && line[first] != '#' &&
+        line[0] != '%' && !line.starts_with("...")) {
+      return true;
+    }
+
+    if (newline == std::string_view::npos) {
+      break;
+    }
+
+    text.remove_prefix(newline + 1);
+  }
+
+  return false;
+}
+
+}  // namespace
+
+YamlSource::YamlSource(std::string filename, std::string_view text)
+    : filename_(std::move(filename)) {
+  std::string separator;
+  std::string document;
+
+  auto finish_segment = [this, &separator, &document] {
+    bool has_content = HasContent(document);
+
+    segments_.push_back(
+        {std::move(separator),
+         std::make_shared<const std::string>(std::move(document))});
+
+    if (has_content) {
+      document_segments_.push_back(segments_.size() - 1);
+    }
+
+    separator.clear();
+    document.clear();
+  };
+
+  while (!text.empty()) {
+    size_t newline = text.find('\n');
+    size_t line_length =
+        newline == std::string_view::npos ? text.size() : newline + 1;
+    std::string_view line = text.substr(0, line_length);
+
+    size_t separator_length = GetSeparatorLength(line);
+    if (separator_length > 0) {
+      finish_segment();
+
+      separator = line.substr(0, separator_length);
+      document = line.substr(separator_length);
+    } else {
+      document.append(line);
+    }
+
+    text.remove_prefix(line_length);
+  }
+
+  finish_segment();
+
+  UpdateLines();
+}
+
+void YamlSource::SetDocument(size_t index,
+                             std::shared_ptr<const std::string> text) {
+  size_t segment_index = document_segments_[index];
+
+  // The next separator has to start on its own line.
+  if (segment_index + 1 < segments_.size() && !text->empty() &&
+      text->back() != '\n') {
+    text = std::make_shared<const std::string>(*text + '\n');
+  }
+
+  segments_[segment_index].text = std::move(text);
+
+  UpdateLines();
+}
+
+void YamlSource::UpdateLines() {
+  int line = 0;
+  for (Segment& segment : segments_) {
+    line +=
+        std::count(segment.separator.begin(), segment.separator.end(), '\n');
+    segment.first_line = line;
+    line += std::count(segment.text->begin(), segment.text->end(), '\n');
+  }
+}
+
+std::string YamlSource::GetText() const {
+  size_t size = 0;
+  for (const Segment& segment : segments_) {
+    size += segment.separator.size() + segment.text->size();
+  }
+
+  std::string text;
+  text.reserve(size);
+
+  for (const Segment& segment : segments_) {
+    text.append(segment.separator);
+    text.append(*segment.text);
+  }
+
+  return text;
+}
@@ -0,0 +1,50 @@
+#ifndef YAML_SOURCE_H_2F6D8B41
+#define YAML_SOURCE_H_2F6D8B41
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The text of a YAML file containing several "---"-separated documents, kept
+// split up so that one document can be replaced while every other byte of the
+// file stays as it was. Documents are found by scanning for separator lines,
+// without parsing anything.
+class YamlSource {
+ public:
+  YamlSource(std::string filename, std::string_view text);
+
+  const std::string& GetFilename() const { return filename_; }
+
+  // Documents that contain nothing but comments are not counted.
+  size_t GetDocumentCount() const { return document_segments_.size(); }
+
+  const std::shared_ptr<const std::string>& GetDocument(size_t index) const {
+    return segments_[document_segments_[index]].text;
+  }
+
+  // The line of the file the document starts on, counting from zero.
+  int GetDocumentLine(size_t index) const {
+    return segments_[document_segments_[index]].first_line;
+  }
+
+  void SetDocument(size_t index, std::shared_ptr<const std::string> text);
+
+  // Reassembles the whole file.
+  std::string GetText() const;
+
+ private:
+  struct Segment {
+    std::string separator;  // the "---" line, if any, including its newline
+    std::shared_ptr<const std::string> text;
+    int first_line = 0;  // of the text, which may follow the separator
+  };
+
+  void UpdateLines();
+
+  std::string filename_;
+  std::vector<Segment> segments_;
+  std::vector<size_t> document_segments_;
+};
+
+#endif /* end of include guard: YAML_SOURCE_H_2F6D8B41 */
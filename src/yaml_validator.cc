@@ -0,0 +1,173 @@
+#include "yaml_validator.h"
+
+#include <yaml-cpp/yaml.h>
+
+#include "game_definition.h"
+#include "string_view_stream.h"
+#include "world.h"
+
+std::optional<std::vector<YamlProblem>> ValidateYaml(
+    const GameDefinitions& game_definitions, const std::string& text,
+    const std::function<bool()>& is_cancelled) {
+  std::vector<YamlProblem> problems;
+
+  YAML::Node node;
+  try {
+    StringViewIStream text_stream(text);
+    node = YAML::Load(text_stream);
+  } catch (const YAML::Exception& ex) {
+    YamlProblem problem;
+    problem.line = ex.mark.line;
+    problem.column = ex.mark.column;
+    problem.message = ex.msg;
+
+    problems.push_back(std::move(problem));
+    return problems;
+  }
+
+  if (is_cancelled()) {
+    return std::nullopt;
+  }
+
+  if (!node.IsMap()) {
+    if (!node.IsNull()) {
+      YamlProblem problem;
+      problem.line = node.Mark().line;
+      problem.column = node.Mark().column;
+      problem.message = "The document should be a map.";
+
+      problems.push_back(std::move(problem));
+    }
+
+    return problems;
+  }
+
+  World world(&game_definitions);
+  try {
+    world.FromNode(node);
+  } catch (const std::exception& ex) {
+    YamlProblem problem;
+    problem.message = ex.what();
+
+    if (node["game"]) {
+      problem.line = node["game"].Mark().line;
+      problem.column = node["game"].Mark().column;
+    }
+
+    problems.push_back(std::move(problem));
+    return problems;
+  }
+
+  if (is_cancelled()) {
+    return std::nullopt;
+  }
+
+  if (world.HasGame() && node[world.GetGame()] &&
+      node[world.GetGame()].IsMap()) {
+    const YAML::Node& game_node = node[world.GetGame()];
+
+    for (YAML::const_iterator it = game_node.begin(); it != game_node.end();
+         it++) {
+      std::string option_name = it->first.as<std::string>();
+
+      // Every key that names an option has a value in the world, even if it
+      // is an invalid one.
+      if (!world.HasOption(option_name)) {
+        YamlProblem problem;
+        problem.line = it->first.Mark().line;
+        problem.column = it->first.Mark().column;
+        problem.length = option_name.size();
+        problem.warning = true;
+        problem.message = "Unknown option \"" + option_name + "\".";
+
+        problems.push_back(std::move(problem));
+        continue;
+      }
+
+      // Point at the offending value where it is known, and at the option's
+      // key otherwise.
+      for (const Diagnostic& diagnostic : world.GetOptionErrors(option_name)) {
+        YamlProblem problem;
+        if (diagnostic.line >= 0) {
+          problem.line = diagnostic.line;
+          problem.column = diagnostic.column;
+          problem.length = diagnostic.value.size();
+        } else {
+          problem.line = it->first.Mark().line;
+          problem.column = it->first.Mark().column;
+          problem.length = option_name.size();
+        }
+        problem.message = FormatDiagnostic(diagnostic);
+
+        problems.push_back(std::move(problem));
+      }
+    }
+  }
+
+  return problems;
+}
+
+YamlValidator::YamlValidator(const GameDefinitions* game_definitions,
+                             Callback callback)
+    : game_definitions_(game_definitions), callback_(std::move(callback)) {
+  thread_ = std::thread([this] { Run(); });
+}
+
+YamlValidator::~YamlValidator() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+    generation_++;
+  }
+
+  cv_.notify_one();
+  thread_.join();
+}
+
+uint64_t YamlValidator::Submit(std::string text) {
+  uint64_t generation;
+
+  {
+    std::lock_guard lock(mutex_);
+    generation = ++generation_;
+    pending_text_ = std::move(text);
+  }
+
+  cv_.notify_one();
+
+  return generation;
+}
+
+void YamlValidator::Cancel() {
+  std::lock_guard lock(mutex_);
+  generation_++;
+  pending_text_ = std::nullopt;
+}
+
+void YamlValidator::Run() {
+  for (;;) {
+    std::string text;
+    uint64_t generation;
+
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || pending_text_.has_value(); });
+
+      if (stop_) {
+        return;
+      }
+
+      text = std::move(*pending_text_);
+      pending_text_ = std::nullopt;
+      generation = generation_;
+    }
+
+    std::optional<std::vector<YamlProblem>> problems =
+        ValidateYaml(*game_definitions_, text,
+                     [this, generation] { return generation_ != generation; });
+
+    if (problems && generation_ == generation) {
+      callback_(generation, std::move(*problems));
+    }
+  }
+}
@@ -0,0 +1,67 @@
+#ifndef YAML_VALIDATOR_H_D6E1B7A4
+#define YAML_VALIDATOR_H_D6E1B7A4
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GameDefinitions;
+
+struct YamlProblem {
+  int line = 0;    // zero-indexed
+  int column = 0;  // zero-indexed
+  int length = 0;  // zero means "until the end of the line"
+  bool warning = false;
+
+  std::string message;
+};
+
+// Parses and validates a YAML document against the game definitions. Returns
+// std::nullopt if is_cancelled reports true before validation finishes.
+std::optional<std::vector<YamlProblem>> ValidateYaml(
+    const GameDefinitions& game_definitions, const std::string& text,
+    const std::function<bool()>& is_cancelled);
+
+// Runs ValidateYaml on a background thread. Only the most recently submitted
+// document is ever validated; older submissions are dropped or, if already
+// running, abandoned. The callback is invoked on the background thread.
+class YamlValidator {
+ public:
+  using Callback =
+      std::function<void(uint64_t generation, std::vector<YamlProblem>)>;
+
+  YamlValidator(const GameDefinitions* game_definitions, Callback callback);
+
+  ~YamlValidator();
+
+  // Returns the generation number that the result will be reported with.
+  uint64_t Submit(std::string text);
+
+  // Abandons any pending or running validation.
+  void Cancel();
+
+  uint64_t GetGeneration() const { return generation_; }
+
+ private:
+  void Run();
+
+  const GameDefinitions* game_definitions_;
+  Callback callback_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::optional<std::string> pending_text_;
+  bool stop_ = false;
+
+  std::atomic<uint64_t> generation_ = 0;
+
+  std::thread thread_;
+};
+
+#endif /* end of include guard: YAML_VALIDATOR_H_D6E1B7A4 */
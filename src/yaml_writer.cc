@@ -0,0 +1,241 @@
+#include "yaml_writer.h"
+
+#include <charconv>
+
+namespace {
+
+bool HasPlainTag(const YAML::Node& node) {
+  const std::string& tag = node.Tag();
+  return tag.empty() || tag == "?" || tag == "!";
+}
+
+bool IsBlockCollection(const YAML::Node& node) {
+  return (node.IsMap() || node.IsSequence()) && node.size() > 0 &&
+         node.Style() != YAML::EmitterStyle::Flow && HasPlainTag(node);
+}
+
+bool IsYamlSpace(char ch) { return ch == ' ' || ch == '\t'; }
+
+}  // namespace
+
+bool IsPlainYamlScalar(std::string_view value) {
+  if (value.empty() || IsYamlSpace(value.front()) ||
+      IsYamlSpace(value.back()) || value.back() == ':') {
+    return false;
+  }
+
+  if (value == "~" || value == "null" || value == "Null" || value == "NULL" ||
+      value.starts_with("---") || value.starts_with("...")) {
+    return false;
+  }
+
+  switch (value.front()) {
+    case '[':
+    case ']':
+    case '{':
+    case '}':
+    case ',':
+    case '#':
+    case '&':
+    case '*':
+    case '!':
+    case '|':
+    case '>':
+    case '\'':
+    case '"':
+    case '%':
+    case '@':
+    case '`': {
+      return false;
+    }
+    case '-':
+    case '?':
+    case ':': {
+      if (value.size() == 1 || IsYamlSpace(value[1])) {
+        return false;
+      }
+      break;
+    }
+  }
+
+  for (size_t i = 0; i < value.size(); i++) {
+    unsigned char ch = value[i];
+    if (ch < 0x20 || ch == 0x7f) {
+      return false;
+    }
+
+    if (ch == ':' && i + 1 < value.size() && IsYamlSpace(value[i + 1])) {
+      return false;
+    }
+
+    if (ch == '#' && i > 0 && IsYamlSpace(value[i - 1])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void AppendYamlScalar(std::string& output, std::string_view value) {
+  if (IsPlainYamlScalar(value)) {
+    output.append(value);
+    return;
+  }
+
+  output.push_back('"');
+  for (char ch : value) {
+    switch (ch) {
+      case '"': {
+        output.append("\\\"");
+        break;
+      }
+      case '\\': {
+        output.append("\\\\");
+        break;
+      }
+      case '\n': {
+        output.append("\\n");
+        break;
+      }
+      case '\t': {
+        output.append("\\t");
+        break;
+      }
+      case '\r': {
+        output.append("\\r");
+        break;
+      }
+      default: {
+        unsigned char code = ch;
+        if (code < 0x20 || code == 0x7f) {
+          static constexpr char kHexDigits[] = "0123456789abcdef";
+          output.append("\\x");
+          output.push_back(kHexDigits[code >> 4]);
+          output.push_back(kHexDigits[code & 0xf]);
+        } else {
+          output.push_back(ch);
+        }
+        break;
+      }
+    }
+  }
+  output.push_back('"');
+}
+
+void YamlWriter::WriteKey(std::string_view key, int indent) {
+  WriteIndent(indent);
+  AppendYamlScalar(output_, key);
+  output_.push_back(':');
+}
+
+void YamlWriter::WriteIntKey(int key, int indent) {
+  WriteIndent(indent);
+  WriteInt(key);
+  output_.push_back(':');
+}
+
+void YamlWriter::WriteScalarValue(std::string_view value) {
+  output_.push_back(' ');
+  AppendYamlScalar(output_, value);
+  output_.push_back('\n');
+}
+
+void YamlWriter::WriteIntValue(int value) {
+  output_.push_back(' ');
+  WriteInt(value);
+  output_.push_back('\n');
+}
+
+void YamlWriter::WriteRawValue(std::string_view value) {
+  output_.push_back(' ');
+  output_.append(value);
+  output_.push_back('\n');
+}
+
+void YamlWriter::BeginBlockValue() { output_.push_back('\n'); }
+
+void YamlWriter::WriteSequenceItem(std::string_view value, int indent) {
+  WriteIndent(indent);
+  output_.append("- ");
+  AppendYamlScalar(output_, value);
+  output_.push_back('\n');
+}
+
+void YamlWriter::WriteNodeValue(const YAML::Node& node, int indent) {
+  if (IsBlockCollection(node)) {
+    size_t start = output_.size();
+    BeginBlockValue();
+
+    if (node.IsMap() ? WriteBlockMap(node, indent + 2)
+                     : WriteBlockSequence(node, indent + 2)) {
+      return;
+    }
+
+    output_.resize(start);
+  }
+
+  output_.push_back(' ');
+  if (node.IsScalar() && HasPlainTag(node)) {
+    AppendYamlScalar(output_, node.Scalar());
+  } else if (!node.IsDefined() || node.IsNull()) {
+    output_.push_back('~');
+  } else {
+    WriteEmitted(node);
+  }
+  output_.push_back('\n');
+}
+
+void YamlWriter::WriteDocument(const YAML::Node& node) {
+  if (node.IsMap() && IsBlockCollection(node) && WriteBlockMap(node, 0)) {
+    return;
+  }
+
+  YAML::Emitter emitter;
+  emitter << node;
+
+  output_.append(emitter.c_str(), emitter.size());
+  output_.push_back('\n');
+}
+
+void YamlWriter::WriteIndent(int indent) { output_.append(indent, ' '); }
+
+void YamlWriter::WriteInt(int value) {
+  char buffer[16];
+  auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  output_.append(buffer, end);
+}
+
+bool YamlWriter::WriteBlockMap(const YAML::Node& node, int indent) {
+  size_t start = output_.size();
+
+  for (YAML::const_iterator it = node.begin(); it != node.end(); it++) {
+    if (!it->first.IsScalar() || !HasPlainTag(it->first)) {
+      output_.resize(start);
+      return false;
+    }
+
+    WriteKey(it->first.Scalar(), indent);
+    WriteNodeValue(it->second, indent);
+  }
+
+  return true;
+}
+
+bool YamlWriter::WriteBlockSequence(const YAML::Node& node, int indent) {
+  for (const YAML::Node& item : node) {
+    WriteIndent(indent);
+    output_.push_back('-');
+    WriteNodeValue(item, indent);
+  }
+
+  return true;
+}
+
+void YamlWriter::WriteEmitted(const YAML::Node& node) {
+  YAML::Emitter emitter;
+  emitter.SetMapFormat(YAML::Flow);
+  emitter.SetSeqFormat(YAML::Flow);
+  emitter << node;
+
+  output_.append(emitter.c_str(), emitter.size());
+}
@@ -0,0 +1,72 @@
+#ifndef YAML_WRITER_H_7B3E19D4
+#define YAML_WRITER_H_7B3E19D4
+
+#include <yaml-cpp/yaml.h>
+
+#include <string>
+#include <string_view>
+
+// Returns whether the string can be written as a plain (unquoted) scalar in
+// block context without changing its meaning.
+bool IsPlainYamlScalar(std::string_view value);
+
+// Appends the string as a plain scalar if possible, and as a double-quoted
+// scalar otherwise.
+void AppendYamlScalar(std::string& output, std::string_view value);
+
+// Writes block-style YAML straight into one contiguous buffer. This produces
+// the same documents as yaml-cpp's emitter (semantically, though not always
+// byte for byte) for the shapes used by player YAMLs, and falls back to the
+// emitter for anything unusual (flow collections, tags, complex keys).
+//
+// Callers write map entries as a key followed by exactly one value. Indent is
+// the number of spaces before the key.
+class YamlWriter {
+ public:
+  void WriteKey(std::string_view key, int indent);
+
+  void WriteIntKey(int key, int indent);
+
+  void WriteScalarValue(std::string_view value);
+
+  void WriteIntValue(int value);
+
+  // Writes a value that is given as a flow collection, e.g. "[]".
+  void WriteRawValue(std::string_view value);
+
+  // Ends the key's line, so that a nested block mapping or sequence can follow
+  // at a deeper indent.
+  void BeginBlockValue();
+
+  void WriteSequenceItem(std::string_view value, int indent);
+
+  // Writes an arbitrary node as the value of the preceding key (or sequence
+  // dash) at the given indent.
+  void WriteNodeValue(const YAML::Node& node, int indent);
+
+  // Writes an arbitrary node as a whole document.
+  void WriteDocument(const YAML::Node& node);
+
+  const std::string& GetOutput() const { return output_; }
+
+  std::string Release() { return std::move(output_); }
+
+ private:
+  void WriteIndent(int indent);
+
+  void WriteInt(int value);
+
+  // Writes the entries of a block map or sequence. Returns false, having
+  // written nothing, if the node needs the full emitter.
+  bool WriteBlockMap(const YAML::Node& node, int indent);
+
+  bool WriteBlockSequence(const YAML::Node& node, int indent);
+
+  // Writes the node through yaml-cpp, in flow style so that it fits on the
+  // current line.
+  void WriteEmitted(const YAML::Node& node);
+
+  std::string output_;
+};
+
+#endif /* end of include guard: YAML_WRITER_H_7B3E19D4 */
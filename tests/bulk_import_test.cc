@@ -0,0 +1,80 @@
+// bulk_import_test: checks what ParseBulkImport makes of pasted text,
+// including text it can't use.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "bulk_import.h"
+#include "double_map.h"
+
+namespace {
+
+int failures = 0;
+
+DoubleMap<std::string> GetOptionSet() {
+  DoubleMap<std::string> option_set;
+  for (const char* value : {"Sword", "Shield", "Bow", "Small Key"}) {
+    option_set.Append(value);
+  }
+
+  return option_set;
+}
+
+std::string Describe(const BulkImportResult& result) {
+  const DoubleMap<std::string> option_set = GetOptionSet();
+
+  std::string description;
+  for (const auto& [id, amount] : result.entries) {
+    description += option_set.GetValue(id) + "=" + std::to_string(amount) + ";";
+  }
+  for (const UnknownImportEntry& unknown : result.unknown) {
+    description +=
+        "?" + unknown.name + "@" + std::to_string(unknown.line) + ";";
+  }
+
+  return description;
+}
+
+void Check(std::string_view text, std::string_view expected) {
+  std::string actual;
+  try {
+    actual = Describe(ParseBulkImport(GetOptionSet(), text));
+  } catch (const std::exception& ex) {
+    actual = std::string("threw: ") + ex.what();
+  }
+
+  if (actual != expected) {
+    std::cerr << "Parsing \"" << text << "\" gave \"" << actual
+              << "\", expected \"" << expected << "\"" << std::endl;
+    failures++;
+  }
+}
+
+}  // namespace
+
+int main() {
+  Check("Sword\n- Bow\nSmall Key: 3", "Sword=1;Bow=1;Small Key=3;");
+  Check("[Sword, Bow]", "Sword=1;Bow=1;");
+  Check("{Sword: 2, Bow}", "Sword=2;Bow=1;");
+
+  // Nested flow collections can't name a value, so the line is reported.
+  Check("[[Sword]]", "?[[Sword]]@1;");
+  Check("[Sword, [Bow]]", "?[Sword, [Bow]]@1;");
+  Check("{Sword: [1]}", "?{Sword: [1]}@1;");
+  Check("{[Sword]: 1}", "?{[Sword]: 1}@1;");
+  Check("start_inventory: {Sword: {Bow: 1}}", "?{Sword: {Bow: 1}}@1;");
+
+  // Keys without values are headers only if something is nested under them.
+  Check("start_inventory:\n  Sword: 2\n  Bow: 1", "Sword=2;Bow=1;");
+  Check("local_items:\n- Sword", "Sword=1;");
+  Check("Sword:\nBow", "Sword=1;Bow=1;");
+  Check("Unknown:\nBow", "Bow=1;?Unknown@1;");
+  Check("Bow\nUnknown:", "Bow=1;?Unknown@2;");
+  Check("Unknown:\n\n# comment\n  Bow", "Bow=1;");
+
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
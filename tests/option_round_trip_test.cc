@@ -0,0 +1,397 @@
+// option_round_trip_test: writes values of every kind for every option with
+// the writer worlds are saved with, reads them back with yaml-cpp the way
+// worlds are loaded, and checks that they come back equal, with the same
+// HashOptionValue.
+//
+// Runs over every game in the given dumped-options.json, or the one next to
+// the executable, or generated option data if there is neither, and always
+// over a game whose names need the writer's quoting rules.
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core_util.h"
+#include "game_definition.h"
+#include "synthetic_data.h"
+#include "world.h"
+
+namespace {
+
+constexpr const char* kUsage =
+    "Usage: option_round_trip_test [--definitions FILE]\n";
+
+// Strings that can't all be written as plain scalars: YAML indicators, words
+// and numbers a resolver would treat as something other than a string,
+// significant spaces, escapes and text outside ASCII.
+const std::vector<std::string> kTrickyStrings = {
+    "yes",
+    "no",
+    "true",
+    "False",
+    "null",
+    "Null",
+    "NULL",
+    "~",
+    "on",
+    "off",
+    "100",
+    "-5",
+    "0x1F",
+    "1e3",
+    ".inf",
+    "3.14",
+    " leading space",
+    "trailing space ",
+    " ",
+    "\tleading tab",
+    "colon: space",
+    "ends with colon:",
+    "a:b",
+    "#hash",
+    "not # a comment",
+    "a#b",
+    "- dash",
+    "-dash",
+    "? question",
+    "?question",
+    ": colon",
+    ":colon",
+    "[bracket",
+    "]",
+    "{brace",
+    "}",
+    "a, b",
+    ",comma",
+    "&anchor",
+    "*alias",
+    "!tag",
+    "|pipe",
+    ">fold",
+    "'single",
+    "\"double",
+    "quote \" inside",
+    "back\\slash",
+    "%percent",
+    "@at",
+    "`backtick",
+    "---",
+    "...",
+    "--- x",
+    "new\nline",
+    "carriage\rreturn",
+    "tab\tinside",
+    "\x01control",
+    "delete\x7f",
+    "\xc3\xbc" "n" "\xc3\xaf" "c" "\xc3\xb6" "d" "\xc3\xa9",  // "unicode", with diacritics
+    "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e",  // "Japanese", in Japanese
+    "Sword (Progressive)",
+    "two  spaces",
+};
+
+// Option names the writer has to quote too, one per option type.
+std::string GetTrickyOptionName(int index) {
+  return kTrickyStrings[index * 7 % kTrickyStrings.size()];
+}
+
+std::string GenerateQuotingOptions() {
+  nlohmann::ordered_json game;
+  game["items"] = kTrickyStrings;
+  game["items"].push_back("");
+  game["itemGroups"] = nlohmann::ordered_json::array();
+  game["locations"] = kTrickyStrings;
+  game["locationGroups"] = nlohmann::ordered_json::array();
+  game["commonOptions"] = {"local_items", "start_inventory",
+                           "exclude_locations"};
+
+  nlohmann::ordered_json& options = game["options"];
+
+  nlohmann::ordered_json select;
+  select["type"] = "select";
+  select["options"] = nlohmann::ordered_json::array();
+  for (size_t i = 0; i < kTrickyStrings.size(); i++) {
+    select["options"].push_back(
+        {{"id", i}, {"name", "Choice"}, {"value", kTrickyStrings[i]}});
+  }
+  select["defaultValue"] = kTrickyStrings.front();
+  select["aliases"] = nlohmann::ordered_json::array();
+  options[GetTrickyOptionName(0)] = select;
+
+  // Names that read as numbers would be ambiguous with the values themselves.
+  nlohmann::ordered_json named_range;
+  named_range["type"] = "named_range";
+  named_range["min"] = -10;
+  named_range["max"] = 1000;
+  named_range["defaultValue"] = 0;
+  named_range["value_names"] = nlohmann::ordered_json::object();
+  for (size_t i = 0; i < kTrickyStrings.size(); i++) {
+    const std::string& name = kTrickyStrings[i];
+    if (name.find_first_not_of("0123456789-") != std::string::npos) {
+      named_range["value_names"][name] = i * 10;
+    }
+  }
+  options[GetTrickyOptionName(1)] = named_range;
+
+  nlohmann::ordered_json custom_set;
+  custom_set["type"] = "options-set";
+  custom_set["options"] = kTrickyStrings;
+  custom_set["defaultValue"] = nlohmann::ordered_json::array();
+  options[GetTrickyOptionName(2)] = custom_set;
+
+  nlohmann::ordered_json items_dict;
+  items_dict["type"] = "items-dict";
+  items_dict["defaultValue"] = nlohmann::ordered_json::array();
+  options[GetTrickyOptionName(3)] = items_dict;
+
+  // Both bounds of random ranges are written with their signs.
+  nlohmann::ordered_json negative_range;
+  negative_range["type"] = "range";
+  negative_range["min"] = -2147483647 - 1;
+  negative_range["max"] = -1;
+  negative_range["defaultValue"] = -1;
+  options[GetTrickyOptionName(4)] = negative_range;
+
+  nlohmann::ordered_json all_games;
+  all_games["Quoting: \"Edge\" Cases"] = game;
+
+  return all_games.dump();
+}
+
+// Values of every kind the option can hold, in the form that reading them
+// back produces.
+std::vector<OptionValue> GetValuesToWrite(const Game& game,
+                                          const OptionDefinition& option) {
+  std::vector<OptionValue> values;
+
+  if (option.type == kSelectOption) {
+    OptionValue weighted;
+    weighted.random = true;
+
+    for (const auto& [id, name] : option.choices.GetItems()) {
+      // An empty name is how a choice by ID is stored.
+      if (!name.empty()) {
+        OptionValue by_name;
+        by_name.string_value = name;
+        values.push_back(by_name);
+
+        by_name.weight = weighted.weighting->size() + 1;
+        weighted.weighting.Mutable().push_back(by_name);
+      }
+
+      std::string id_text = std::to_string(id);
+      if (!option.choices.HasValue(id_text) && !option.aliases.count(id_text)) {
+        OptionValue by_id;
+        by_id.int_value = id;
+        values.push_back(by_id);
+      }
+    }
+
+    // A choice named "random" takes the place of the specifier.
+    if (!option.choices.HasValue("random")) {
+      OptionValue random;
+      random.random = true;
+      values.push_back(random);
+
+      random.weight = weighted.weighting->size() + 1;
+      weighted.weighting.Mutable().push_back(random);
+    }
+
+    if (weighted.weighting->size() > 1) {
+      values.push_back(weighted);
+    }
+  } else if (option.type == kRangeOption) {
+    std::vector<int> numbers = {
+        option.min_value, option.max_value,
+        option.min_value + (option.max_value - option.min_value) / 2};
+    for (const auto& [number, name] : option.value_names.GetItems()) {
+      numbers.push_back(number);
+    }
+
+    OptionValue weighted;
+    weighted.random = true;
+
+    for (int number : numbers) {
+      OptionValue value;
+      value.int_value = number;
+      values.push_back(value);
+
+      bool listed = false;
+      for (const OptionValue& weight_value : *weighted.weighting) {
+        listed |= weight_value.int_value == number;
+      }
+      if (!listed) {
+        value.weight = weighted.weighting->size() + 1;
+        weighted.weighting.Mutable().push_back(value);
+      }
+    }
+
+    std::string bounds = std::to_string(option.min_value) + "-" +
+                         std::to_string(option.max_value);
+    for (const std::string& specifier :
+         {std::string("random"), std::string("random-low"),
+          std::string("random-middle"), std::string("random-high"),
+          "random-range-" + bounds, "random-range-low-" + bounds,
+          "random-range-high-" + bounds}) {
+      // Specifiers that don't parse are reported by CheckGame.
+      OptionValue value = GetRandomOptionValueFromString(specifier);
+      values.push_back(value);
+
+      value.weight = weighted.weighting->size() + 1;
+      weighted.weighting.Mutable().push_back(value);
+    }
+
+    if (weighted.weighting->size() > 1) {
+      values.push_back(weighted);
+    }
+  } else if (option.type == kSetOption) {
+    size_t size = GetOptionSetElements(game, option.name).size();
+
+    OptionValue none;
+    none.set_values.Mutable().resize(size);
+    values.push_back(none);
+
+    OptionValue all;
+    all.set_values.Mutable().assign(size, true);
+    values.push_back(all);
+
+    OptionValue alternate;
+    std::vector<bool>& set_values = alternate.set_values.Mutable();
+    for (size_t i = 0; i < size; i++) {
+      set_values.push_back(i % 2 == 0);
+    }
+    values.push_back(alternate);
+  } else if (option.type == kDictOption) {
+    size_t size = GetOptionSetElements(game, option.name).size();
+
+    values.push_back(OptionValue());
+
+    OptionValue all;
+    std::map<int, int>& dict_values = all.dict_values.Mutable();
+    for (size_t i = 0; i < size; i++) {
+      dict_values[i] = i % 5 + 1;
+    }
+    values.push_back(all);
+  }
+
+  return values;
+}
+
+// Returns the number of values that didn't survive.
+int CheckGame(const Game& game) {
+  int failures = 0;
+  int checked = 0;
+
+  for (const OptionDefinition& option : game.GetOptions()) {
+    std::vector<OptionValue> values = GetValuesToWrite(game, option);
+
+    // Different values should hash differently, if only to show that the
+    // hash covers every kind of value.
+    for (size_t i = 0; i < values.size(); i++) {
+      for (size_t j = 0; j < i; j++) {
+        if (values[i] != values[j] &&
+            HashOptionValue(values[i]) == HashOptionValue(values[j])) {
+          std::cerr << game.GetName() << ": \"" << option.name
+                    << "\" has different values with the same hash"
+                    << std::endl;
+          failures++;
+        }
+      }
+    }
+
+    for (const OptionValue& value : values) {
+      checked++;
+
+      if (!value.errors.empty()) {
+        std::cerr << game.GetName() << ": \"" << option.name
+                  << "\" has a random specifier that doesn't parse"
+                  << std::endl;
+        failures++;
+
+        continue;
+      }
+
+      std::string text = OptionValueToYaml(game, option.name, value);
+
+      try {
+        OptionValue read_value = OptionValueFromYaml(game, option.name, text);
+        if (read_value == value &&
+            HashOptionValue(read_value) == HashOptionValue(value)) {
+          continue;
+        }
+
+        std::cerr << game.GetName() << ": \"" << option.name
+                  << "\" read back differently, or with a different hash, "
+                     "from:\n"
+                  << text << std::endl;
+      } catch (const std::exception& ex) {
+        std::cerr << game.GetName() << ": \"" << option.name
+                  << "\" could not be read back (" << ex.what()
+                  << ") from:\n"
+                  << text << std::endl;
+      }
+
+      failures++;
+    }
+  }
+
+  std::cout << game.GetName() << ": " << checked - failures << " of "
+            << checked << " values round-tripped" << std::endl;
+
+  return failures;
+}
+
+int CheckDefinitions(const std::string& filename) {
+  GameDefinitions game_definitions(filename);
+
+  int failures = 0;
+  for (const std::string& game : game_definitions.GetAllGames()) {
+    failures += CheckGame(game_definitions.GetGame(game));
+  }
+
+  return failures;
+}
+
+std::string WriteTemporaryFile(const std::string& name,
+                               const std::string& text) {
+  std::filesystem::path path =
+      std::filesystem::temp_directory_path() / ("ap_wizard_" + name);
+  std::ofstream file(path, std::ios::binary);
+  file << text;
+
+  return path.string();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string definitions;
+  if (argc == 3 && std::string_view(argv[1]) == "--definitions") {
+    definitions = argv[2];
+  } else if (argc != 1) {
+    std::cerr << kUsage;
+    return EXIT_FAILURE;
+  } else if (std::filesystem::exists(GetExecutableDirectory() /
+                                     "dumped-options.json")) {
+    definitions = (GetExecutableDirectory() / "dumped-options.json").string();
+  } else {
+    definitions = WriteTemporaryFile("round_trip_options.json",
+                                     GenerateDumpedOptions({}));
+  }
+
+  int failures = 0;
+  try {
+    failures += CheckDefinitions(definitions);
+    failures += CheckDefinitions(WriteTemporaryFile(
+        "round_trip_quoting.json", GenerateQuotingOptions()));
+  } catch (const std::exception& ex) {
+    std::cerr << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}